@@ -7,6 +7,7 @@
 #include "Cpu0.h"
 
 #include "Cpu0RegisterInfo.h"
+#include "MCTargetDesc/Cpu0AnalyzeImmediate.h"
 #include "MCTargetDesc/Cpu0MCExpr.h"
 #include "MCTargetDesc/Cpu0MCTargetDesc.h"
 #include "llvm/ADT/APInt.h"
@@ -54,6 +55,7 @@ namespace {
 class Cpu0AsmParser : public MCTargetAsmParser {
   MCAsmParser &Parser;
   Cpu0AssemblerOptions Options;
+  Cpu0AnalyzeImmediate AnalyzeImm;
 
 #define GET_ASSEMBLER_HEADER
 #include "Cpu0GenAsmMatcher.inc"
@@ -327,45 +329,34 @@ void Cpu0AsmParser::expandInstruction(MCInst &Inst, SMLoc IDLoc,
 
 void Cpu0AsmParser::expandLoadImm(MCInst &Inst, SMLoc IDLoc,
                                   SmallVectorImpl<MCInst> &Instructions) {
-  MCInst tmpInst;
   const MCOperand &ImmOp = Inst.getOperand(1);
   assert(ImmOp.isImm() && "expected immediate operand kind");
   const MCOperand &RegOp = Inst.getOperand(0);
   assert(RegOp.isReg() && "expected register operand kind");
 
+  // li d,j => the same shortest sequence codegen uses, e.g.
+  //           addiu d,$zero,j    or    lui d,hi16(j)
+  //                                    ori d,d,lo16(j)
+  unsigned Reg = RegOp.getReg();
   int ImmValue = ImmOp.getImm();
-  tmpInst.setLoc(IDLoc);
-  if (0 <= ImmValue && ImmValue <= 65535) {
-    // for 0 <= j <= 65535.
-    // li d,j => ori d,$zero,j
-    tmpInst.setOpcode(Cpu0::ORi);
-    tmpInst.addOperand(MCOperand::createReg(RegOp.getReg()));
-    tmpInst.addOperand(MCOperand::createReg(Cpu0::ZERO));
-    tmpInst.addOperand(MCOperand::createImm(ImmValue));
-    Instructions.push_back(tmpInst);
-  } else if (ImmValue < 0 && ImmValue >= -32768) {
-    // for -32768 <= j < 0.
-    // li d,j => addiu d,$zero,j
-    tmpInst.setOpcode(Cpu0::ADDiu); // TODO:no ADDiu64 in td files?
-    tmpInst.addOperand(MCOperand::createReg(RegOp.getReg()));
-    tmpInst.addOperand(MCOperand::createReg(Cpu0::ZERO));
-    tmpInst.addOperand(MCOperand::createImm(ImmValue));
-    Instructions.push_back(tmpInst);
-  } else {
-    // for any other value of j that is representable as a 32-bit integer.
-    // li d,j => lui d,hi16(j)
-    //           ori d,d,lo16(j)
-    tmpInst.setOpcode(Cpu0::LUi);
-    tmpInst.addOperand(MCOperand::createReg(RegOp.getReg()));
-    tmpInst.addOperand(MCOperand::createImm((ImmValue & 0xffff0000) >> 16));
-    Instructions.push_back(tmpInst);
-    tmpInst.clear();
-    tmpInst.setOpcode(Cpu0::ORi);
-    tmpInst.addOperand(MCOperand::createReg(RegOp.getReg()));
-    tmpInst.addOperand(MCOperand::createReg(RegOp.getReg()));
-    tmpInst.addOperand(MCOperand::createImm(ImmValue & 0xffff));
+  const Cpu0AnalyzeImmediate::InstSeq &Seq =
+      AnalyzeImm.Analyze(ImmValue, 32, false);
+
+  unsigned SrcReg = Cpu0::ZERO;
+  for (const Cpu0AnalyzeImmediate::Inst &I : Seq) {
+    MCInst tmpInst;
     tmpInst.setLoc(IDLoc);
+    tmpInst.setOpcode(I.Opc);
+    tmpInst.addOperand(MCOperand::createReg(Reg));
+    // Only LUi has no source register.
+    if (I.Opc != Cpu0::LUi)
+      tmpInst.addOperand(MCOperand::createReg(SrcReg));
+    int64_t Imm = I.ImmOpnd;
+    if (I.Opc == Cpu0::ADDiu)
+      Imm = SignExtend64<16>(Imm);
+    tmpInst.addOperand(MCOperand::createImm(Imm));
     Instructions.push_back(tmpInst);
+    SrcReg = Reg;
   }
 }
 
@@ -517,6 +508,7 @@ int Cpu0AsmParser::matchRegisterName(StringRef Name) {
            .Case("hi", Cpu0::HI)
            .Case("lo", Cpu0::LO)
            .Case("epc", Cpu0::EPC)
+           .Case("tp", Cpu0::TP)
            .Default(-1);
 
   if (CC != -1)
@@ -23,6 +23,8 @@ class FunctionPass;
 
 FunctionPass *createCpu0BranchExpansion();
 void initializeCpu0BranchExpansionPass(PassRegistry &);
+FunctionPass *createCpu0RedundantCmpElim();
+void initializeCpu0RedundantCmpElimPass(PassRegistry &);
 
 } // namespace llvm
 
@@ -14,6 +14,7 @@
 
 #include "Cpu0.h"
 #include "Cpu0InstrInfo.h"
+#include "Cpu0TargetObjectFile.h"
 #include "MCTargetDesc/Cpu0BaseInfo.h"
 #include "MCTargetDesc/Cpu0InstPrinter.h"
 #include "MCTargetDesc/Cpu0MCAsmInfo.h"
@@ -229,9 +230,12 @@ void Cpu0AsmPrinter::emitFunctionBodyStart() {
   MCInstLowering.Initialize(&MF->getContext());
 
   emitFrameDirective();
-  bool EmitCPLoad = (MF->getTarget().getRelocationModel() == Reloc::PIC_) &&
-                    Cpu0FI->globalBaseRegSet() && Cpu0FI->globalBaseRegFixed();
-  if (Cpu0NoCpload)
+  // Functions that inherit $gp from their callers skip .cpload.
+  bool EmitCPLoad =
+      (MF->getTarget().getRelocationModel() == Reloc::PIC_) &&
+      Cpu0FI->globalBaseRegSet() && Cpu0FI->globalBaseRegFixed() &&
+      !Cpu0FunctionInfo::inheritsGlobalBaseReg(MF->getFunction());
+  if (Subtarget->noCpload())
     EmitCPLoad = false;
 
   if (OutStreamer->hasRawTextSupport()) {
@@ -273,6 +277,14 @@ void Cpu0AsmPrinter::emitFunctionBodyEnd() {
   }
 }
 
+bool Cpu0AsmPrinter::doInitialization(Module &M) {
+  // The small section picks are per module; this runs before instruction
+  // selection of M's first function asks for them.
+  static_cast<const Cpu0TargetObjectFile &>(getObjFileLowering())
+      .resetModuleAnalysis();
+  return AsmPrinter::doInitialization(M);
+}
+
 //	.section .mdebug.abi32
 //	.previous
 void Cpu0AsmPrinter::emitStartOfAsmFile(Module &M) {
@@ -385,6 +397,18 @@ void Cpu0AsmPrinter::printOperand(const MachineInstr *MI, int opNum,
   case Cpu0II::MO_GOT_LO16:
     O << "%got_lo16(";
     break;
+  case Cpu0II::MO_TLSGD:
+    O << "%tlsgd(";
+    break;
+  case Cpu0II::MO_GOTTPREL:
+    O << "%gottprel(";
+    break;
+  case Cpu0II::MO_TP_HI:
+    O << "%tp_hi(";
+    break;
+  case Cpu0II::MO_TP_LO:
+    O << "%tp_lo(";
+    break;
   }
 
   switch (MO.getType()) {
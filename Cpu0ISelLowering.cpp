@@ -49,6 +49,7 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalValue.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Value.h"
 #include "llvm/MC/MCContext.h"
@@ -58,6 +59,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/KnownBits.h"
 #include "llvm/Support/MachineValueType.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
@@ -76,6 +78,21 @@ using namespace llvm;
 
 #define DEBUG_TYPE "cpu0-lower"
 
+static cl::opt<unsigned> JumpTableMinEntries(
+    "cpu0-min-jump-table-entries", cl::Hidden, cl::init(5),
+    cl::desc("Minimum number of cases to lower a switch to a jump table "
+             "(default=5)"));
+
+static cl::opt<unsigned> MulDecomposeMaxOps(
+    "cpu0-mul-decompose-max-ops", cl::Hidden, cl::init(8),
+    cl::desc("Maximum number of shift/add instructions a multiply by a "
+             "constant may be expanded into (default=8)"));
+
+static cl::opt<unsigned> JumpTableDensity(
+    "cpu0-jump-table-density", cl::Hidden, cl::init(25),
+    cl::desc("Minimum percentage of non-default cases in a jump table "
+             "(default=25)"));
+
 SDValue Cpu0TargetLowering::getGlobalReg(SelectionDAG &DAG, EVT Ty) const {
   Cpu0FunctionInfo *FI = DAG.getMachineFunction().getInfo<Cpu0FunctionInfo>();
   return DAG.getRegister(FI->getGlobalBaseReg(), Ty);
@@ -119,6 +136,8 @@ const char *Cpu0TargetLowering::getTargetNodeName(unsigned Opcode) const {
     return "Cpu0ISD::Lo";
   case Cpu0ISD::GPRel:
     return "Cpu0ISD::GPRel";
+  case Cpu0ISD::ThreadPointer:
+    return "Cpu0ISD::ThreadPointer";
   case Cpu0ISD::Ret:
     return "Cpu0ISD::Ret";
   case Cpu0ISD::EH_RETURN:
@@ -129,6 +148,10 @@ const char *Cpu0TargetLowering::getTargetNodeName(unsigned Opcode) const {
     return "Cpu0ISD::DivRemU";
   case Cpu0ISD::Wrapper:
     return "Cpu0ISD::Wrapper";
+  case Cpu0ISD::DynAlloc:
+    return "Cpu0ISD::DynAlloc";
+  case Cpu0ISD::Sync:
+    return "Cpu0ISD::Sync";
   default:
     return NULL;
   }
@@ -159,9 +182,28 @@ Cpu0TargetLowering::Cpu0TargetLowering(const Cpu0TargetMachine &TM,
 
   // Cpu0 Custom Operations
   setOperationAction(ISD::GlobalAddress, MVT::i32, Custom);
+  setOperationAction(ISD::GlobalTLSAddress, MVT::i32, Custom);
   setOperationAction(ISD::BlockAddress, MVT::i32, Custom);
   setOperationAction(ISD::JumpTable, MVT::i32, Custom);
+  setOperationAction(ISD::BR_JT, MVT::Other, Custom);
   setOperationAction(ISD::BRCOND, MVT::Other, Custom);
+  setOperationAction(ISD::VASTART, MVT::Other, Custom);
+  setOperationAction(ISD::VAARG, MVT::Other, Custom);
+  setOperationAction(ISD::BSWAP, MVT::i32, Custom);
+  setOperationAction(ISD::FSHL, MVT::i32, Custom);
+  setOperationAction(ISD::FSHR, MVT::i32, Custom);
+  setOperationAction(ISD::UADDO, MVT::i32, Custom);
+  setOperationAction(ISD::USUBO, MVT::i32, Custom);
+  setOperationAction(ISD::SADDO, MVT::i32, Custom);
+  setOperationAction(ISD::SSUBO, MVT::i32, Custom);
+  setOperationAction(ISD::UMULO, MVT::i32, Custom);
+  setOperationAction(ISD::SETCC, MVT::i64, Custom);
+  setOperationAction(ISD::SMIN, MVT::i32, Custom);
+  setOperationAction(ISD::SMAX, MVT::i32, Custom);
+  setOperationAction(ISD::UMIN, MVT::i32, Custom);
+  setOperationAction(ISD::UMAX, MVT::i32, Custom);
+  setOperationAction(ISD::ABS, MVT::i32, Custom);
+  setOperationAction(ISD::ATOMIC_FENCE, MVT::Other, Custom);
 
   // Handle i64 shl
   setOperationAction(ISD::SHL_PARTS, MVT::i32, Expand);
@@ -174,7 +216,6 @@ Cpu0TargetLowering::Cpu0TargetLowering(const Cpu0TargetMachine &TM,
   setOperationAction(ISD::UREM, MVT::i32, Expand);
 
   // Operations not directly supported by Cpu0.
-  setOperationAction(ISD::BR_JT, MVT::Other, Expand);
   setOperationAction(ISD::BR_CC, MVT::i32, Expand);
   setOperationAction(ISD::CTPOP, MVT::i32, Expand);
   setOperationAction(ISD::CTTZ, MVT::i32, Expand);
@@ -187,8 +228,46 @@ Cpu0TargetLowering::Cpu0TargetLowering(const Cpu0TargetMachine &TM,
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i32, Expand);
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::Other, Expand);
 
+  // Aligned loads and stores up to 32 bits are atomic, AtomicExpand brackets
+  // the ordered ones with fences and turns wider atomics into __atomic_*
+  // calls.
+  setMaxAtomicSizeInBitsSupported(32);
+
+  // With ll/sc compare-and-swap is inline and narrower ones are masked in IR.
+  // Without it read-modify-write operations become __sync_* calls.
+  if (Subtarget.hasLLSC()) {
+    setMinCmpXchgSizeInBits(32);
+  } else {
+    for (MVT VT : {MVT::i8, MVT::i16, MVT::i32}) {
+      setOperationAction(ISD::ATOMIC_CMP_SWAP, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_SWAP, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_ADD, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_SUB, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_AND, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_OR, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_XOR, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_NAND, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_MIN, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_MAX, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_UMIN, VT, LibCall);
+      setOperationAction(ISD::ATOMIC_LOAD_UMAX, VT, LibCall);
+    }
+  }
+
+  // va_copy copies the pointer, va_end does nothing.
+  setOperationAction(ISD::VACOPY, MVT::Other, Expand);
+  setOperationAction(ISD::VAEND, MVT::Other, Expand);
+
   setTargetDAGCombine(ISD::SDIVREM);
   setTargetDAGCombine(ISD::UDIVREM);
+  setTargetDAGCombine(ISD::MUL);
+  setTargetDAGCombine(ISD::AND);
+  setTargetDAGCombine(ISD::OR);
+
+  // A jump table dispatch costs a bounds check, a scaled load and a jr, while
+  // every case of a compare chain costs an immediate load plus a compare and
+  // branch, so tables pay off from a handful of cases on.
+  setMinimumJumpTableEntries(JumpTableMinEntries);
 
   //- Set .align 2
   // It will emit .align 2 later
@@ -243,6 +322,179 @@ static SDValue performDivRemCombine(SDNode *N, SelectionDAG &DAG,
   return SDValue();
 }
 
+// A multiply by a constant with few signed binary digits is expanded into
+// shifts and adds when that is cheaper than MUL plus loading the constant,
+// e.g. x * 21 => ((x << 4) + (x << 2)) + x. Constants of the form
+// (2^N +- 1) << M are already handled by DAGCombiner through
+// decomposeMulByConstant.
+static SDValue performMULCombine(SDNode *N, SelectionDAG &DAG,
+                                 TargetLowering::DAGCombinerInfo &DCI,
+                                 const Cpu0Subtarget &Subtarget) {
+  EVT VT = N->getValueType(0);
+  ConstantSDNode *C = dyn_cast<ConstantSDNode>(N->getOperand(1));
+
+  if (VT != MVT::i32 || !C ||
+      DAG.getMachineFunction().getFunction().hasMinSize())
+    return SDValue();
+
+  // Non-adjacent form: Imm == sum of (IsNeg ? -1 : 1) << Shift, with the
+  // fewest non-zero terms. Bits above 31 do not matter for an i32 result.
+  SmallVector<std::pair<unsigned, bool>, 8> Terms;
+  int64_t Imm = C->getSExtValue();
+  for (unsigned Shift = 0; Imm != 0 && Shift < 32; ++Shift, Imm >>= 1) {
+    if (!(Imm & 1))
+      continue;
+    int64_t Digit = 2 - (Imm & 3);
+    Terms.push_back(std::make_pair(Shift, Digit < 0));
+    Imm -= Digit;
+  }
+
+  if (Terms.size() < 2)
+    return SDValue();
+
+  unsigned Ops = Terms.size() - 1;
+  for (const auto &T : Terms)
+    if (T.first)
+      ++Ops;
+  auto Pos = llvm::find_if(
+      Terms, [](const std::pair<unsigned, bool> &T) { return !T.second; });
+  if (Pos == Terms.end())
+    ++Ops;
+
+  // Compare against MUL and the one or two instructions loading the
+  // constant, using the latencies of the schedule model.
+  const InstrItineraryData *Itins = Subtarget.getInstrItineraryData();
+  const TargetInstrInfo *TII = Subtarget.getInstrInfo();
+  unsigned MulLat = Itins->getStageLatency(TII->get(Cpu0::MUL).getSchedClass());
+  unsigned AluLat =
+      Itins->getStageLatency(TII->get(Cpu0::ADDiu).getSchedClass());
+  int64_t CVal = C->getSExtValue();
+  unsigned ImmOps =
+      (isInt<16>(CVal) || isUInt<16>(CVal) || !(CVal & 0xffff)) ? 1 : 2;
+
+  if (Ops > MulDecomposeMaxOps || Ops * AluLat >= MulLat + ImmOps * AluLat)
+    return SDValue();
+
+  SDLoc DL(N);
+  SDValue X = N->getOperand(0);
+  auto getTerm = [&](unsigned Shift) {
+    if (!Shift)
+      return X;
+    return DAG.getNode(ISD::SHL, DL, VT, X, DAG.getConstant(Shift, DL, VT));
+  };
+
+  // Start from a positive term, so only an all negative sum needs 0 - ...
+  SDValue Res = Pos == Terms.end() ? DAG.getConstant(0, DL, VT)
+                                   : getTerm(Pos->first);
+  for (auto I = Terms.begin(), E = Terms.end(); I != E; ++I) {
+    if (I == Pos)
+      continue;
+    Res = DAG.getNode(I->second ? ISD::SUB : ISD::ADD, DL, VT, Res,
+                      getTerm(I->first));
+  }
+
+  return Res;
+}
+
+// An and mask that does not fit the 16-bit zero-extended immediate of andi
+// costs a lui/ori pair. Rewrite such masks into shifts:
+//   (and (shl x, s), m)        -> (shl (and x, m >> s), s), if m >> s fits
+//   (and (srl x, s), low mask) -> (srl (shl x, 32 - s - w), 32 - w)
+//   (and x, low mask)          -> (srl (shl x, 32 - w), 32 - w)
+//   (and x, high mask)         -> (shl (srl x, t), t)
+// where w is the width of the low mask and t the trailing zeros of the high
+// mask. A high mask with its low half clear is a single lui, leave it.
+static SDValue performANDCombine(SDNode *N, SelectionDAG &DAG,
+                                 TargetLowering::DAGCombinerInfo &DCI,
+                                 const Cpu0Subtarget &Subtarget) {
+  EVT VT = N->getValueType(0);
+  ConstantSDNode *C = dyn_cast<ConstantSDNode>(N->getOperand(1));
+
+  if (VT != MVT::i32 || !C)
+    return SDValue();
+
+  uint32_t Mask = C->getZExtValue();
+  if (isUInt<16>(Mask) || !(Mask & 0xffff))
+    return SDValue();
+
+  SDLoc DL(N);
+  SDValue Src = N->getOperand(0);
+  unsigned Bits = VT.getSizeInBits();
+  ConstantSDNode *ShAmt = nullptr;
+  if ((Src.getOpcode() == ISD::SHL || Src.getOpcode() == ISD::SRL) &&
+      Src.hasOneUse())
+    ShAmt = dyn_cast<ConstantSDNode>(Src.getOperand(1));
+  unsigned S = ShAmt ? ShAmt->getZExtValue() : 0;
+
+  if (Src.getOpcode() == ISD::SHL && ShAmt && S < Bits &&
+      isUInt<16>(Mask >> S)) {
+    SDValue And = DAG.getNode(ISD::AND, DL, VT, Src.getOperand(0),
+                              DAG.getConstant(Mask >> S, DL, VT));
+    return DAG.getNode(ISD::SHL, DL, VT, And, Src.getOperand(1));
+  }
+
+  if (isMask_32(Mask)) {
+    unsigned Width = countTrailingOnes(Mask);
+    SDValue X = Src;
+    if (Src.getOpcode() == ISD::SRL && ShAmt && S + Width < Bits)
+      X = Src.getOperand(0);
+    else
+      S = 0;
+    SDValue Shl = DAG.getNode(ISD::SHL, DL, VT, X,
+                              DAG.getConstant(Bits - S - Width, DL, VT));
+    return DAG.getNode(ISD::SRL, DL, VT, Shl,
+                       DAG.getConstant(Bits - Width, DL, VT));
+  }
+
+  if (isMask_32(~Mask)) {
+    SDValue Amt = DAG.getConstant(countTrailingZeros(Mask), DL, VT);
+    SDValue Srl = DAG.getNode(ISD::SRL, DL, VT, Src, Amt);
+    return DAG.getNode(ISD::SHL, DL, VT, Srl, Amt);
+  }
+
+  return SDValue();
+}
+
+// Bit-field insert, (or (and x, ~m), y) with y only having bits in m.
+// Clearing the field needs ~m in a register (lui/ori); when m itself fits
+// andi, merge through the field instead:
+//   (xor x, (and (xor x, y), m))
+static SDValue performORCombine(SDNode *N, SelectionDAG &DAG,
+                                TargetLowering::DAGCombinerInfo &DCI,
+                                const Cpu0Subtarget &Subtarget) {
+  EVT VT = N->getValueType(0);
+  if (VT != MVT::i32)
+    return SDValue();
+
+  for (unsigned I = 0; I < 2; ++I) {
+    SDValue AndX = N->getOperand(I);
+    SDValue Y = N->getOperand(1 - I);
+    if (AndX.getOpcode() != ISD::AND || !AndX.hasOneUse())
+      continue;
+
+    ConstantSDNode *C = dyn_cast<ConstantSDNode>(AndX.getOperand(1));
+    if (!C)
+      continue;
+
+    uint32_t Keep = C->getZExtValue();
+    uint32_t Field = ~Keep;
+    if (isUInt<16>(Keep) || !(Keep & 0xffff) || !isUInt<16>(Field))
+      continue;
+
+    KnownBits Known = DAG.computeKnownBits(Y);
+    if ((Known.Zero.getZExtValue() & Keep) != Keep)
+      continue;
+
+    SDLoc DL(N);
+    SDValue X = AndX.getOperand(0);
+    SDValue Diff = DAG.getNode(ISD::XOR, DL, VT, X, Y);
+    Diff = DAG.getNode(ISD::AND, DL, VT, Diff, DAG.getConstant(Field, DL, VT));
+    return DAG.getNode(ISD::XOR, DL, VT, X, Diff);
+  }
+
+  return SDValue();
+}
+
 SDValue Cpu0TargetLowering::PerformDAGCombine(SDNode *N,
                                               DAGCombinerInfo &DCI) const {
   SelectionDAG &DAG = DCI.DAG;
@@ -254,6 +506,12 @@ SDValue Cpu0TargetLowering::PerformDAGCombine(SDNode *N,
   case ISD::SDIVREM:
   case ISD::UDIVREM:
     return performDivRemCombine(N, DAG, DCI, Subtarget);
+  case ISD::MUL:
+    return performMULCombine(N, DAG, DCI, Subtarget);
+  case ISD::AND:
+    return performANDCombine(N, DAG, DCI, Subtarget);
+  case ISD::OR:
+    return performORCombine(N, DAG, DCI, Subtarget);
   }
 
   return SDValue();
@@ -262,14 +520,44 @@ SDValue Cpu0TargetLowering::PerformDAGCombine(SDNode *N,
 SDValue Cpu0TargetLowering::LowerOperation(SDValue Op,
                                            SelectionDAG &DAG) const {
   switch (Op.getOpcode()) {
+  case ISD::BR_JT:
+    return lowerBR_JT(Op, DAG);
   case ISD::BRCOND:
     return lowerBRCOND(Op, DAG);
   case ISD::GlobalAddress:
     return lowerGlobalAddress(Op, DAG);
+  case ISD::GlobalTLSAddress:
+    return lowerGlobalTLSAddress(Op, DAG);
   case ISD::BlockAddress:
     return lowerBlockAddress(Op, DAG);
   case ISD::JumpTable:
     return lowerJumpTable(Op, DAG);
+  case ISD::VASTART:
+    return lowerVASTART(Op, DAG);
+  case ISD::VAARG:
+    return lowerVAARG(Op, DAG);
+  case ISD::BSWAP:
+    return lowerBSWAP(Op, DAG);
+  case ISD::FSHL:
+  case ISD::FSHR:
+    return lowerFunnelShift(Op, DAG);
+  case ISD::UADDO:
+  case ISD::USUBO:
+  case ISD::SADDO:
+  case ISD::SSUBO:
+  case ISD::UMULO:
+    return lowerXALUO(Op, DAG);
+  case ISD::SETCC:
+    return lowerSETCC64(Op, DAG);
+  case ISD::SMIN:
+  case ISD::SMAX:
+  case ISD::UMIN:
+  case ISD::UMAX:
+    return lowerMINMAX(Op, DAG);
+  case ISD::ABS:
+    return lowerABS(Op, DAG);
+  case ISD::ATOMIC_FENCE:
+    return lowerATOMIC_FENCE(Op, DAG);
   }
   return SDValue();
 }
@@ -281,6 +569,124 @@ SDValue Cpu0TargetLowering::LowerOperation(SDValue Op,
 //===----------------------------------------------------------------------===//
 //  Misc Lower Operation implementation
 //===----------------------------------------------------------------------===//
+unsigned Cpu0TargetLowering::getJumpTableEncoding() const {
+  // In PIC mode emit $gp relative entries (.gpword), so the table itself needs
+  // no dynamic relocations and the dispatch only adds $gp back.
+  if (isPositionIndependent())
+    return MachineJumpTableInfo::EK_GPRel32BlockAddress;
+
+  return TargetLowering::getJumpTableEncoding();
+}
+
+// Whether Imm fits the immediate of the andi/ori/xori (Opc) or addiu form.
+static bool isImmForOpcode(unsigned Opc, uint64_t Imm) {
+  if (Opc == ISD::ADD)
+    return isInt<16>(SignExtend64<32>(Imm));
+  return isUInt<16>(Imm);
+}
+
+// Keep a logic op with an immediate inside a shift when moving it out would
+// grow the immediate past 16 bits.
+bool Cpu0TargetLowering::isDesirableToCommuteWithShift(
+    const SDNode *N, CombineLevel Level) const {
+  SDValue Op = N->getOperand(0);
+  ConstantSDNode *ShAmt = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if (!ShAmt || N->getValueType(0) != MVT::i32)
+    return true;
+
+  unsigned Opc = Op.getOpcode();
+  if (Opc != ISD::AND && Opc != ISD::OR && Opc != ISD::XOR && Opc != ISD::ADD)
+    return true;
+  ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op.getOperand(1));
+  if (!C || ShAmt->getZExtValue() >= 32)
+    return true;
+
+  uint32_t Imm = C->getZExtValue();
+  unsigned S = ShAmt->getZExtValue();
+  uint32_t Shifted = N->getOpcode() == ISD::SHL ? Imm << S : Imm >> S;
+  return !isImmForOpcode(Opc, Imm) || isImmForOpcode(Opc, Shifted);
+}
+
+// (shl (srl x, c1), c2) and (srl (shl x, c1), c2) are two shifts; turning
+// them into a shift and an and only pays when the mask fits andi.
+bool Cpu0TargetLowering::shouldFoldConstantShiftPairToMask(
+    const SDNode *N, CombineLevel Level) const {
+  ConstantSDNode *C1 = dyn_cast<ConstantSDNode>(N->getOperand(0).getOperand(1));
+  ConstantSDNode *C2 = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if (!C1 || !C2 || N->getValueType(0) != MVT::i32 ||
+      C1->getZExtValue() >= 32 || C2->getZExtValue() >= 32)
+    return true;
+
+  uint32_t Mask = ~0U;
+  if (N->getOpcode() == ISD::SHL)
+    Mask = (Mask >> C1->getZExtValue()) << C2->getZExtValue();
+  else
+    Mask = (Mask << C1->getZExtValue()) >> C2->getZExtValue();
+  return isUInt<16>(Mask);
+}
+
+// MUL takes 17 cycles, two shifts and an add or sub are always cheaper.
+// Mirror the (2^N +- 1) << M forms DAGCombiner knows how to expand.
+bool Cpu0TargetLowering::decomposeMulByConstant(LLVMContext &Context, EVT VT,
+                                                SDValue C) const {
+  if (VT != MVT::i32)
+    return false;
+
+  ConstantSDNode *ConstNode = dyn_cast<ConstantSDNode>(C.getNode());
+  if (!ConstNode)
+    return false;
+
+  APInt Imm = ConstNode->getAPIntValue().abs();
+  if (Imm.ule(2))
+    return false;
+  Imm.lshrInPlace(Imm.countTrailingZeros());
+  return (Imm - 1).isPowerOf2() || (Imm + 1).isPowerOf2();
+}
+
+bool Cpu0TargetLowering::isSuitableForJumpTable(const SwitchInst *SI,
+                                                uint64_t NumCases,
+                                                uint64_t Range,
+                                                ProfileSummaryInfo *PSI,
+                                                BlockFrequencyInfo *BFI) const {
+  if (SI->getFunction()->hasOptSize())
+    return TargetLowering::isSuitableForJumpTable(SI, NumCases, Range, PSI,
+                                                  BFI);
+
+  // A table entry is one word, a case in a compare chain is at least two
+  // instructions, so sparser tables than the generic 40% are still a win.
+  uint64_t MaxJumpTableSize = getMaximumJumpTableSize();
+  return (!MaxJumpTableSize || Range <= MaxJumpTableSize) &&
+         NumCases * 100 >= Range * JumpTableDensity;
+}
+
+// (brind (load (add table, (shl index, 2))))
+// In PIC mode the loaded entry is relative to $gp.
+SDValue Cpu0TargetLowering::lowerBR_JT(SDValue Op, SelectionDAG &DAG) const {
+  SDValue Chain = Op.getOperand(0);
+  SDValue Table = Op.getOperand(1);
+  SDValue Index = Op.getOperand(2);
+  SDLoc DL(Op);
+  const DataLayout &TD = DAG.getDataLayout();
+  EVT PTy = getPointerTy(TD);
+  MachineFunction &MF = DAG.getMachineFunction();
+  unsigned EntrySize = MF.getJumpTableInfo()->getEntrySize(TD);
+
+  Index = DAG.getNode(ISD::MUL, DL, PTy, Index,
+                      DAG.getConstant(EntrySize, DL, PTy));
+  SDValue Addr = DAG.getNode(ISD::ADD, DL, PTy, Index, Table);
+
+  EVT MemVT = EVT::getIntegerVT(*DAG.getContext(), EntrySize * 8);
+  Addr = DAG.getExtLoad(ISD::SEXTLOAD, DL, PTy, Chain, Addr,
+                        MachinePointerInfo::getJumpTable(MF), MemVT);
+  Chain = Addr.getValue(1);
+
+  if (isPositionIndependent())
+    Addr = DAG.getNode(ISD::ADD, DL, PTy, Addr,
+                       getPICJumpTableRelocBase(Table, DAG));
+
+  return DAG.getNode(ISD::BRIND, DL, MVT::Other, Chain, Addr);
+}
+
 SDValue Cpu0TargetLowering::lowerBRCOND(SDValue Op, SelectionDAG &DAG) const {
   return Op;
 }
@@ -305,7 +711,7 @@ SDValue Cpu0TargetLowering::lowerGlobalAddress(SDValue Op,
           DAG.getTargetGlobalAddress(GV, DL, MVT::i32, 0, Cpu0II::MO_GPREL);
       SDValue GPRelNode =
           DAG.getNode(Cpu0ISD::GPRel, DL, DAG.getVTList(MVT::i32), GA);
-      SDValue GPReg = DAG.getRegister(Cpu0::GP, MVT::i32);
+      SDValue GPReg = getGlobalReg(DAG, MVT::i32);
       return DAG.getNode(ISD::ADD, DL, MVT::i32, GPReg, GPRelNode);
     }
 
@@ -318,7 +724,8 @@ SDValue Cpu0TargetLowering::lowerGlobalAddress(SDValue Op,
 
   //@large section
   const GlobalObject *GO = GV->getAliaseeObject();
-  if (GO && !TLOF->IsGlobalInSmallSection(GO, getTargetMachine()))
+  if (getTargetMachine().getCodeModel() == CodeModel::Large ||
+      (GO && !TLOF->IsGlobalInSmallSection(GO, getTargetMachine())))
     return getAddrGlobalLargeGOT(
         N, Ty, DAG, Cpu0II::MO_GOT_HI16, Cpu0II::MO_GOT_LO16,
         DAG.getEntryNode(),
@@ -327,6 +734,67 @@ SDValue Cpu0TargetLowering::lowerGlobalAddress(SDValue Op,
                        MachinePointerInfo::getGOT(DAG.getMachineFunction()));
 }
 
+// Local-exec adds the %tp_hi/%tp_lo offset to $tp, initial-exec loads the
+// offset from the GOT. The dynamic models call __tls_get_addr, local-dynamic
+// is handled as general-dynamic.
+SDValue Cpu0TargetLowering::lowerGlobalTLSAddress(SDValue Op,
+                                                  SelectionDAG &DAG) const {
+  GlobalAddressSDNode *GA = cast<GlobalAddressSDNode>(Op);
+  if (DAG.getTarget().useEmulatedTLS())
+    return LowerToTLSEmulatedModel(GA, DAG);
+
+  SDLoc DL(GA);
+  const GlobalValue *GV = GA->getGlobal();
+  EVT PtrVT = getPointerTy(DAG.getDataLayout());
+  TLSModel::Model Model = getTargetMachine().getTLSModel(GV);
+
+  if (Model == TLSModel::GeneralDynamic || Model == TLSModel::LocalDynamic) {
+    // addiu $4, $gp, %tlsgd(sym); jsub __tls_get_addr
+    // %tlsgd is a signed GOT offset, so unlike a Wrapper it is added.
+    SDValue TGA = DAG.getTargetGlobalAddress(GV, DL, PtrVT, 0,
+                                             Cpu0II::MO_TLSGD);
+    SDValue Argument =
+        DAG.getNode(ISD::ADD, DL, PtrVT, getGlobalReg(DAG, PtrVT),
+                    DAG.getNode(Cpu0ISD::GPRel, DL, PtrVT, TGA));
+    Type *PtrTy = Type::getInt32PtrTy(*DAG.getContext());
+
+    ArgListTy Args;
+    ArgListEntry Entry;
+    Entry.Node = Argument;
+    Entry.Ty = PtrTy;
+    Args.push_back(Entry);
+
+    TargetLowering::CallLoweringInfo CLI(DAG);
+    CLI.setDebugLoc(DL)
+        .setChain(DAG.getEntryNode())
+        .setLibCallee(CallingConv::C, PtrTy,
+                      DAG.getExternalSymbol("__tls_get_addr", PtrVT),
+                      std::move(Args));
+    return LowerCallTo(CLI).first;
+  }
+
+  SDValue Offset;
+  if (Model == TLSModel::InitialExec) {
+    // ld $r, %gottprel(sym)($gp)
+    Offset = getAddrGlobal(GA, PtrVT, DAG, Cpu0II::MO_GOTTPREL,
+                           DAG.getEntryNode(),
+                           MachinePointerInfo::getGOT(DAG.getMachineFunction()));
+  } else {
+    // lui $r, %tp_hi(sym); ori $r, $r, %tp_lo(sym)
+    assert(Model == TLSModel::LocalExec);
+    SDValue TGAHi = DAG.getTargetGlobalAddress(GV, DL, PtrVT, 0,
+                                               Cpu0II::MO_TP_HI);
+    SDValue TGALo = DAG.getTargetGlobalAddress(GV, DL, PtrVT, 0,
+                                               Cpu0II::MO_TP_LO);
+    Offset = DAG.getNode(ISD::ADD, DL, PtrVT,
+                         DAG.getNode(Cpu0ISD::Hi, DL, PtrVT, TGAHi),
+                         DAG.getNode(Cpu0ISD::Lo, DL, PtrVT, TGALo));
+  }
+
+  SDValue ThreadPointer = DAG.getNode(Cpu0ISD::ThreadPointer, DL, PtrVT);
+  return DAG.getNode(ISD::ADD, DL, PtrVT, ThreadPointer, Offset);
+}
+
 SDValue Cpu0TargetLowering::lowerBlockAddress(SDValue Op,
                                               SelectionDAG &DAG) const {
   BlockAddressSDNode *N = cast<BlockAddressSDNode>(Op);
@@ -349,12 +817,682 @@ SDValue Cpu0TargetLowering::lowerJumpTable(SDValue Op,
   return getAddrLocal(N, Ty, DAG);
 }
 
+SDValue Cpu0TargetLowering::lowerVASTART(SDValue Op, SelectionDAG &DAG) const {
+  MachineFunction &MF = DAG.getMachineFunction();
+  Cpu0FunctionInfo *FuncInfo = MF.getInfo<Cpu0FunctionInfo>();
+
+  SDLoc DL(Op);
+  SDValue FI = DAG.getFrameIndex(FuncInfo->getVarArgsFrameIndex(),
+                                 getPointerTy(MF.getDataLayout()));
+
+  // vastart just stores the address of the VarArgsFrameIndex slot into the
+  // memory location argument.
+  const Value *SV = cast<SrcValueSDNode>(Op.getOperand(2))->getValue();
+  return DAG.getStore(Op.getOperand(0), DL, FI, Op.getOperand(1),
+                      MachinePointerInfo(SV));
+}
+
+// All variable arguments live in one contiguous area (the register home slots
+// followed by the stack arguments), so va_arg is a load and a pointer bump.
+SDValue Cpu0TargetLowering::lowerVAARG(SDValue Op, SelectionDAG &DAG) const {
+  SDNode *Node = Op.getNode();
+  EVT VT = Node->getValueType(0);
+  SDValue Chain = Node->getOperand(0);
+  SDValue VAListPtr = Node->getOperand(1);
+  const Value *SV = cast<SrcValueSDNode>(Node->getOperand(2))->getValue();
+  SDLoc DL(Node);
+  unsigned ArgSlotSizeInBytes = 4;
+
+  SDValue VAListLoad = DAG.getLoad(getPointerTy(DAG.getDataLayout()), DL, Chain,
+                                   VAListPtr, MachinePointerInfo(SV));
+  SDValue VAList = VAListLoad;
+
+  // The pointer is never re-aligned beyond the slot size. CC_Cpu0O32 puts
+  // the halves of a split i64/f64 in consecutive 4-byte slots without
+  // skipping to an even one, while the type legalizer hands the 8-byte ABI
+  // alignment of the whole value to its first half.
+
+  // Increment the pointer, VAList, to the next vaarg.
+  auto &TD = DAG.getDataLayout();
+  unsigned ArgSizeInBytes =
+      TD.getTypeAllocSize(VT.getTypeForEVT(*DAG.getContext()));
+  SDValue Tmp3 =
+      DAG.getNode(ISD::ADD, DL, VAList.getValueType(), VAList,
+                  DAG.getConstant(alignTo(ArgSizeInBytes, ArgSlotSizeInBytes),
+                                  DL, VAList.getValueType()));
+  // Store the incremented VAList to the legalized pointer
+  Chain = DAG.getStore(VAListLoad.getValue(1), DL, Tmp3, VAListPtr,
+                       MachinePointerInfo(SV));
+
+  // In big-endian mode we must adjust the pointer when the load size is
+  // smaller than the argument slot size.
+  if (!Subtarget.isLittle() && ArgSizeInBytes < ArgSlotSizeInBytes) {
+    unsigned Adjustment = ArgSlotSizeInBytes - ArgSizeInBytes;
+    VAList = DAG.getNode(ISD::ADD, DL, VAListPtr.getValueType(), VAList,
+                         DAG.getIntPtrConstant(Adjustment, DL));
+  }
+  // Load the actual argument out of the pointer VAList
+  return DAG.getLoad(VT, DL, Chain, VAList, MachinePointerInfo());
+}
+
+// Byte swap with the rotate instructions:
+//   ror  $t0, $x, 8         // b0 b3 b2 b1, bytes 3 and 1 are in place
+//   rol  $t1, $x, 8         // b2 b1 b0 b3, bytes 2 and 0 are in place
+//   xor  $t0, $t0, $t1
+//   and  $t0, $t0, 0xff00ff00
+//   xor  $r, $t1, $t0
+// The mask is loop invariant and usually hoisted.
+SDValue Cpu0TargetLowering::lowerBSWAP(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  SDValue Src = Op.getOperand(0);
+  SDValue Eight = DAG.getConstant(8, DL, VT);
+
+  SDValue RotR = DAG.getNode(ISD::ROTR, DL, VT, Src, Eight);
+  SDValue RotL = DAG.getNode(ISD::ROTL, DL, VT, Src, Eight);
+  SDValue Diff = DAG.getNode(ISD::XOR, DL, VT, RotR, RotL);
+  Diff = DAG.getNode(ISD::AND, DL, VT, Diff,
+                     DAG.getConstant(0xff00ff00, DL, VT));
+  return DAG.getNode(ISD::XOR, DL, VT, RotL, Diff);
+}
+
+// Overflow-checked arithmetic:
+//   uaddo: addu  $r, $a, $b;  sltu $o, $r, $a
+//   usubo: subu  $r, $a, $b;  sltu $o, $a, $b
+//   umulo: multu $a, $b; mflo $r; mfhi $h;  $o = $h != 0
+// The unsigned carries are the same compare selectAddESubE uses for adde, so
+// they become cmpu/andi on cpu032I. Signed overflow on cpu032I, which has no
+// slt, tests the sign bits instead of comparing:
+//   saddo: $o = ((r ^ a) & (r ^ b)) >> 31
+//   ssubo: $o = ((a ^ b) & (a ^ r)) >> 31
+// On cpu032II the generic slt based expansion is as short.
+SDValue Cpu0TargetLowering::lowerXALUO(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  EVT CCVT = Op->getValueType(1);
+  SDValue LHS = Op.getOperand(0);
+  SDValue RHS = Op.getOperand(1);
+  SDValue Value, Overflow;
+
+  switch (Op.getOpcode()) {
+  default:
+    llvm_unreachable("Unexpected overflow opcode");
+  case ISD::UADDO:
+    Value = DAG.getNode(ISD::ADD, DL, VT, LHS, RHS);
+    Overflow = DAG.getSetCC(DL, CCVT, Value, LHS, ISD::SETULT);
+    break;
+  case ISD::USUBO:
+    Value = DAG.getNode(ISD::SUB, DL, VT, LHS, RHS);
+    Overflow = DAG.getSetCC(DL, CCVT, LHS, RHS, ISD::SETULT);
+    break;
+  case ISD::SADDO:
+  case ISD::SSUBO: {
+    if (Subtarget.hasSlt())
+      return SDValue();
+    bool IsAdd = Op.getOpcode() == ISD::SADDO;
+    Value = DAG.getNode(IsAdd ? ISD::ADD : ISD::SUB, DL, VT, LHS, RHS);
+    SDValue Sign =
+        IsAdd ? DAG.getNode(ISD::AND, DL, VT,
+                            DAG.getNode(ISD::XOR, DL, VT, Value, LHS),
+                            DAG.getNode(ISD::XOR, DL, VT, Value, RHS))
+              : DAG.getNode(ISD::AND, DL, VT,
+                            DAG.getNode(ISD::XOR, DL, VT, LHS, RHS),
+                            DAG.getNode(ISD::XOR, DL, VT, LHS, Value));
+    Overflow = DAG.getNode(ISD::SRL, DL, VT, Sign,
+                           DAG.getConstant(VT.getSizeInBits() - 1, DL, VT));
+    Overflow = DAG.getZExtOrTrunc(Overflow, DL, CCVT);
+    break;
+  }
+  case ISD::UMULO: {
+    SDValue LoHi =
+        DAG.getNode(ISD::UMUL_LOHI, DL, DAG.getVTList(VT, VT), LHS, RHS);
+    Value = LoHi;
+    Overflow = DAG.getSetCC(DL, CCVT, LoHi.getValue(1),
+                            DAG.getConstant(0, DL, VT), ISD::SETNE);
+    break;
+  }
+  }
+
+  return DAG.getMergeValues({Value, Overflow}, DL);
+}
+
+// An ordered i64 compare is built from word compares:
+//   a < b  <=>  hi(a) < hi(b) || (hi(a) == hi(b) && lo(a) <u lo(b))
+// i.e. slt/sltu, sltiu(xor), sltu, and, or on cpu032II and the cmp/andi
+// setcc patterns on cpu032I. A brcond on the result is a single branch.
+// The generic expansion needs a select, which Cpu0 does not have.
+// Equality keeps the generic xor/or form.
+SDValue Cpu0TargetLowering::lowerSETCC64(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  SDValue LHS = Op.getOperand(0);
+  SDValue RHS = Op.getOperand(1);
+  ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(2))->get();
+
+  if (LHS.getValueType() != MVT::i64 || CC == ISD::SETEQ || CC == ISD::SETNE)
+    return SDValue();
+
+  // Canonicalize to LT/ULT/GE/UGE.
+  if (CC == ISD::SETGT || CC == ISD::SETUGT || CC == ISD::SETLE ||
+      CC == ISD::SETULE) {
+    std::swap(LHS, RHS);
+    CC = ISD::getSetCCSwappedOperands(CC);
+  }
+  bool Invert = CC == ISD::SETGE || CC == ISD::SETUGE;
+  bool IsSigned = ISD::isSignedIntSetCC(CC);
+
+  SDValue Zero = DAG.getIntPtrConstant(0, DL);
+  SDValue One = DAG.getIntPtrConstant(1, DL);
+  SDValue LHSLo = DAG.getNode(ISD::EXTRACT_ELEMENT, DL, MVT::i32, LHS, Zero);
+  SDValue LHSHi = DAG.getNode(ISD::EXTRACT_ELEMENT, DL, MVT::i32, LHS, One);
+  SDValue RHSLo = DAG.getNode(ISD::EXTRACT_ELEMENT, DL, MVT::i32, RHS, Zero);
+  SDValue RHSHi = DAG.getNode(ISD::EXTRACT_ELEMENT, DL, MVT::i32, RHS, One);
+
+  SDValue HiLT = DAG.getSetCC(DL, VT, LHSHi, RHSHi,
+                              IsSigned ? ISD::SETLT : ISD::SETULT);
+  SDValue HiEQ = DAG.getSetCC(DL, VT, LHSHi, RHSHi, ISD::SETEQ);
+  SDValue LoLT = DAG.getSetCC(DL, VT, LHSLo, RHSLo, ISD::SETULT);
+  SDValue Res = DAG.getNode(ISD::OR, DL, VT, HiLT,
+                            DAG.getNode(ISD::AND, DL, VT, HiEQ, LoLT));
+  if (Invert)
+    Res = DAG.getNode(ISD::XOR, DL, VT, Res, DAG.getConstant(1, DL, VT));
+  return Res;
+}
+
+// Cpu0 has no conditional move, so the generic min/max expansion ends in a
+// select diamond. Pick with a mask instead:
+//   slt  $c, $a, $b          // sltu, or cmp/andi on cpu032I
+//   subu $m, $zero, $c       // all ones if a is picked
+//   xor  $t, $a, $b
+//   and  $t, $t, $m
+//   xor  $r, $b, $t
+// Five straight-line instructions against a compare, a branch that may
+// mispredict and a move.
+SDValue Cpu0TargetLowering::lowerMINMAX(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  SDValue A = Op.getOperand(0);
+  SDValue B = Op.getOperand(1);
+  ISD::CondCode CC;
+
+  switch (Op.getOpcode()) {
+  default:
+    llvm_unreachable("Unexpected min/max opcode");
+  case ISD::SMIN:
+    CC = ISD::SETLT;
+    break;
+  case ISD::SMAX:
+    CC = ISD::SETGT;
+    break;
+  case ISD::UMIN:
+    CC = ISD::SETULT;
+    break;
+  case ISD::UMAX:
+    CC = ISD::SETUGT;
+    break;
+  }
+
+  SDValue PickA = DAG.getSetCC(DL, VT, A, B, CC);
+  SDValue Mask =
+      DAG.getNode(ISD::SUB, DL, VT, DAG.getConstant(0, DL, VT), PickA);
+  SDValue Diff = DAG.getNode(ISD::XOR, DL, VT, A, B);
+  Diff = DAG.getNode(ISD::AND, DL, VT, Diff, Mask);
+  return DAG.getNode(ISD::XOR, DL, VT, B, Diff);
+}
+
+// abs(x) = (x ^ (x sra 31)) - (x sra 31)
+SDValue Cpu0TargetLowering::lowerABS(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  SDValue X = Op.getOperand(0);
+  SDValue Sign = DAG.getNode(ISD::SRA, DL, VT, X,
+                             DAG.getConstant(VT.getSizeInBits() - 1, DL, VT));
+  return DAG.getNode(ISD::SUB, DL, VT, DAG.getNode(ISD::XOR, DL, VT, X, Sign),
+                     Sign);
+}
+
+// A funnel shift of a value with itself is a rotate, a single rol/ror (or
+// rolv/rorv). Other funnel shifts fall back to the generic shl/srl/or
+// expansion.
+SDValue Cpu0TargetLowering::lowerFunnelShift(SDValue Op,
+                                             SelectionDAG &DAG) const {
+  if (Op.getOperand(0) != Op.getOperand(1))
+    return SDValue();
+
+  unsigned RotOpc = Op.getOpcode() == ISD::FSHL ? ISD::ROTL : ISD::ROTR;
+  return DAG.getNode(RotOpc, SDLoc(Op), Op.getValueType(), Op.getOperand(0),
+                     Op.getOperand(2));
+}
+
+// Every fence is a full barrier, "sync 0".
+SDValue Cpu0TargetLowering::lowerATOMIC_FENCE(SDValue Op,
+                                              SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  return DAG.getNode(Cpu0ISD::Sync, DL, MVT::Other, Op.getOperand(0),
+                     DAG.getConstant(0, DL, MVT::i32));
+}
+
+bool Cpu0TargetLowering::shouldInsertFencesForAtomic(
+    const Instruction *I) const {
+  return true;
+}
+
+TargetLowering::AtomicExpansionKind
+Cpu0TargetLowering::shouldExpandAtomicRMWInIR(AtomicRMWInst *AI) const {
+  if (Subtarget.hasLLSC())
+    return AtomicExpansionKind::CmpXChg;
+  return AtomicExpansionKind::None;
+}
+
+MachineBasicBlock *
+Cpu0TargetLowering::EmitInstrWithCustomInserter(MachineInstr &MI,
+                                                MachineBasicBlock *BB) const {
+  switch (MI.getOpcode()) {
+  default:
+    llvm_unreachable("Unexpected instr type to insert");
+  case Cpu0::ATOMIC_CMP_SWAP_I32:
+    return emitAtomicCmpSwap(MI, BB);
+  }
+}
+
+// Expand ATOMIC_CMP_SWAP_I32 into
+//
+// LoopHeadMBB:
+//   ll   dest, 0(ptr)
+//   bne  dest, oldval, ExitMBB
+// LoopTailMBB:
+//   sc   newval, 0(ptr)
+//   beq  newval, $zero, LoopHeadMBB
+// ExitMBB:
+//
+// On cpu032I the branches are cmp + jne/jeq.
+MachineBasicBlock *
+Cpu0TargetLowering::emitAtomicCmpSwap(MachineInstr &MI,
+                                      MachineBasicBlock *BB) const {
+  MachineFunction *MF = BB->getParent();
+  MachineRegisterInfo &RegInfo = MF->getRegInfo();
+  const TargetInstrInfo *TII = Subtarget.getInstrInfo();
+  DebugLoc DL = MI.getDebugLoc();
+
+  Register Dest = MI.getOperand(0).getReg();
+  Register Ptr = MI.getOperand(1).getReg();
+  Register OldVal = MI.getOperand(2).getReg();
+  Register NewVal = MI.getOperand(3).getReg();
+  Register Success = RegInfo.createVirtualRegister(&Cpu0::GPROutRegClass);
+
+  const BasicBlock *LLVM_BB = BB->getBasicBlock();
+  MachineBasicBlock *LoopHeadMBB = MF->CreateMachineBasicBlock(LLVM_BB);
+  MachineBasicBlock *LoopTailMBB = MF->CreateMachineBasicBlock(LLVM_BB);
+  MachineBasicBlock *ExitMBB = MF->CreateMachineBasicBlock(LLVM_BB);
+  MachineFunction::iterator It = ++BB->getIterator();
+  MF->insert(It, LoopHeadMBB);
+  MF->insert(It, LoopTailMBB);
+  MF->insert(It, ExitMBB);
+
+  // Everything after MI moves to ExitMBB.
+  ExitMBB->splice(ExitMBB->begin(), BB,
+                  std::next(MachineBasicBlock::iterator(MI)), BB->end());
+  ExitMBB->transferSuccessorsAndUpdatePHIs(BB);
+
+  BB->addSuccessor(LoopHeadMBB);
+  LoopHeadMBB->addSuccessor(LoopTailMBB);
+  LoopHeadMBB->addSuccessor(ExitMBB);
+  LoopTailMBB->addSuccessor(LoopHeadMBB);
+  LoopTailMBB->addSuccessor(ExitMBB);
+
+  BuildMI(LoopHeadMBB, DL, TII->get(Cpu0::LL), Dest).addReg(Ptr).addImm(0);
+  BuildMI(LoopTailMBB, DL, TII->get(Cpu0::SC), Success)
+      .addReg(NewVal)
+      .addReg(Ptr)
+      .addImm(0);
+
+  if (Subtarget.hasSlt()) {
+    BuildMI(LoopHeadMBB, DL, TII->get(Cpu0::BNE))
+        .addReg(Dest)
+        .addReg(OldVal)
+        .addMBB(ExitMBB);
+    BuildMI(LoopTailMBB, DL, TII->get(Cpu0::BEQ))
+        .addReg(Success)
+        .addReg(Cpu0::ZERO)
+        .addMBB(LoopHeadMBB);
+  } else {
+    Register SW = RegInfo.createVirtualRegister(&Cpu0::SRRegClass);
+    BuildMI(LoopHeadMBB, DL, TII->get(Cpu0::CMP), SW)
+        .addReg(Dest)
+        .addReg(OldVal);
+    BuildMI(LoopHeadMBB, DL, TII->get(Cpu0::JNE))
+        .addReg(SW)
+        .addMBB(ExitMBB);
+    SW = RegInfo.createVirtualRegister(&Cpu0::SRRegClass);
+    BuildMI(LoopTailMBB, DL, TII->get(Cpu0::CMP), SW)
+        .addReg(Success)
+        .addReg(Cpu0::ZERO);
+    BuildMI(LoopTailMBB, DL, TII->get(Cpu0::JEQ))
+        .addReg(SW)
+        .addMBB(LoopHeadMBB);
+  }
+
+  MI.eraseFromParent();
+  return ExitMBB;
+}
+
 #include "Cpu0GenCallingConv.inc"
 
 //===----------------------------------------------------------------------===//
 //                  Call Calling Convention Implementation
 //===----------------------------------------------------------------------===//
 
+SDValue Cpu0TargetLowering::passArgOnStack(SDValue StackPtr, unsigned Offset,
+                                           SDValue Chain, SDValue Arg,
+                                           const SDLoc &DL,
+                                           SelectionDAG &DAG) const {
+  SDValue PtrOff =
+      DAG.getNode(ISD::ADD, DL, getPointerTy(DAG.getDataLayout()), StackPtr,
+                  DAG.getIntPtrConstant(Offset, DL));
+  return DAG.getStore(Chain, DL, Arg, PtrOff, MachinePointerInfo());
+}
+
+/// needsLongCall - Whether a call to Callee (null for an external symbol)
+/// has to go through a register because jsub's 24-bit offset might not reach
+/// it. The medium code model assumes that a section of this module is in
+/// range, so only callees defined here in the caller's section keep jsub;
+/// the large model assumes nothing.
+static bool needsLongCall(const GlobalValue *Callee, const Function &Caller,
+                          const TargetMachine &TM) {
+  switch (TM.getCodeModel()) {
+  case CodeModel::Small:
+    return false;
+  case CodeModel::Medium:
+    break;
+  case CodeModel::Large:
+    return true;
+  case CodeModel::Tiny:
+  case CodeModel::Kernel:
+    llvm_unreachable("Code model rejected by Cpu0TargetMachine");
+  }
+
+  const Function *F = dyn_cast_or_null<Function>(Callee);
+  if (!F || !F->isStrongDefinitionForLinker())
+    return true;
+  // Comdats and -ffunction-sections give functions sections of their own.
+  if (F->hasComdat() || Caller.hasComdat() || TM.getFunctionSections())
+    return true;
+  return F->getSection() != Caller.getSection();
+}
+
+//@LowerCall {
+/// LowerCall - functions arguments are copied from virtual regs to
+/// (physical regs)/(stack frame), CALLSEQ_START and CALLSEQ_END are emitted.
+SDValue Cpu0TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
+                                      SmallVectorImpl<SDValue> &InVals) const {
+  SelectionDAG &DAG = CLI.DAG;
+  SDLoc DL = CLI.DL;
+  SmallVectorImpl<ISD::OutputArg> &Outs = CLI.Outs;
+  SmallVectorImpl<SDValue> &OutVals = CLI.OutVals;
+  SmallVectorImpl<ISD::InputArg> &Ins = CLI.Ins;
+  SDValue Chain = CLI.Chain;
+  SDValue Callee = CLI.Callee;
+  CallingConv::ID CallConv = CLI.CallConv;
+  bool IsVarArg = CLI.IsVarArg;
+
+  MachineFunction &MF = DAG.getMachineFunction();
+  const TargetFrameLowering *TFL = MF.getSubtarget().getFrameLowering();
+  Cpu0FunctionInfo *FuncInfo = MF.getInfo<Cpu0FunctionInfo>();
+  EVT PtrVT = getPointerTy(DAG.getDataLayout());
+  bool IsPIC = isPositionIndependent();
+
+  // Tail calls are not supported yet.
+  CLI.IsTailCall = false;
+
+  // Analyze operands of the call, assigning locations to each operand.
+  SmallVector<CCValAssign, 16> ArgLocs;
+  CCState CCInfo(CallConv, IsVarArg, MF, ArgLocs, *DAG.getContext());
+  Cpu0CC Cpu0CCInfo(CallConv, ABI.IsO32(), CCInfo);
+
+  Cpu0CCInfo.analyzeCallOperands(Outs);
+
+  // Get a count of how many bytes are to be pushed on the stack.
+  unsigned NextStackOffset = CCInfo.getNextStackOffset();
+  NextStackOffset = alignTo(NextStackOffset, TFL->getStackAlign());
+
+  if (FuncInfo->getMaxCallFrameSize() < NextStackOffset)
+    FuncInfo->setMaxCallFrameSize(NextStackOffset);
+
+  Chain = DAG.getCALLSEQ_START(Chain, NextStackOffset, 0, DL);
+
+  SDValue StackPtr = DAG.getCopyFromReg(Chain, DL, Cpu0::SP, PtrVT);
+
+  std::deque<std::pair<unsigned, SDValue>> RegsToPass;
+  SmallVector<SDValue, 8> MemOpChains;
+
+  // Walk the register/memloc assignments, inserting copies/loads.
+  for (unsigned I = 0, E = ArgLocs.size(); I != E; ++I) {
+    SDValue Arg = OutVals[I];
+    CCValAssign &VA = ArgLocs[I];
+    MVT LocVT = VA.getLocVT();
+    ISD::ArgFlagsTy Flags = Outs[I].Flags;
+
+    //@ByVal Arg {
+    if (Flags.isByVal()) {
+      assert(VA.isMemLoc() && "byval arguments are passed on the stack");
+      assert(Flags.getByValSize() &&
+             "ByVal args of size 0 should have been ignored by front-end.");
+      // The copy lives inside the call sequence, so it must not become a
+      // memcpy call itself.
+      SDValue Dst = DAG.getNode(ISD::ADD, DL, PtrVT, StackPtr,
+                                DAG.getIntPtrConstant(VA.getLocMemOffset(), DL));
+      MemOpChains.push_back(DAG.getMemcpy(
+          Chain, DL, Dst, Arg,
+          DAG.getConstant(Flags.getByValSize(), DL, MVT::i32),
+          Flags.getNonZeroByValAlign(), /*isVol=*/false,
+          /*AlwaysInline=*/true, /*isTailCall=*/false, MachinePointerInfo(),
+          MachinePointerInfo()));
+      continue;
+    }
+    //@ByVal Arg }
+
+    // Promote the value if needed.
+    switch (VA.getLocInfo()) {
+    default:
+      llvm_unreachable("Unknown loc info!");
+    case CCValAssign::Full:
+      break;
+    case CCValAssign::SExt:
+      Arg = DAG.getNode(ISD::SIGN_EXTEND, DL, LocVT, Arg);
+      break;
+    case CCValAssign::ZExt:
+      Arg = DAG.getNode(ISD::ZERO_EXTEND, DL, LocVT, Arg);
+      break;
+    case CCValAssign::AExt:
+      Arg = DAG.getNode(ISD::ANY_EXTEND, DL, LocVT, Arg);
+      break;
+    }
+
+    // Arguments that can be passed on register must be kept at
+    // RegsToPass vector
+    if (VA.isRegLoc()) {
+      RegsToPass.push_back(std::make_pair(VA.getLocReg(), Arg));
+      continue;
+    }
+
+    // Register can't get to this point...
+    assert(VA.isMemLoc());
+
+    // emit ISD::STORE whichs stores the
+    // parameter value to a stack Location
+    MemOpChains.push_back(
+        passArgOnStack(StackPtr, VA.getLocMemOffset(), Chain, Arg, DL, DAG));
+  }
+
+  // Transform all store nodes into one single node because all store
+  // nodes are independent of each other.
+  if (!MemOpChains.empty())
+    Chain = DAG.getNode(ISD::TokenFactor, DL, MVT::Other, MemOpChains);
+
+  // If the callee is a GlobalAddress/ExternalSymbol node (quite common, every
+  // direct call is) turn it into a TargetGlobalAddress/TargetExternalSymbol
+  // node so that legalize doesn't hack it.
+  bool GlobalOrExternal = false;
+  // PIC calls to functions that inherit $gp are direct jsub's, $gp is passed
+  // instead of $t9. Under a non-small code model they may be too far away for
+  // jsub and go through the GOT, but still take $gp from the caller.
+  bool DirectPICCall = false;
+  bool PassGP = false;
+  // When the callee is only known through a register, keep its name on the
+  // call so that -enable-ipra can still propagate its register usage.
+  SDValue CalleeHint;
+  // Large-GOT mode reaches every GOT entry with %got_hi16/%got_lo16.
+  bool LargeGOT =
+      IsPIC && getTargetMachine().getCodeModel() == CodeModel::Large;
+  const GlobalValue *CalleeGV = nullptr;
+  if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee))
+    CalleeGV = G->getGlobal();
+  bool LongCall =
+      needsLongCall(CalleeGV, MF.getFunction(), getTargetMachine());
+
+  if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee)) {
+    const Function *CalleeFn = dyn_cast<Function>(G->getGlobal());
+    PassGP = IsPIC && CalleeFn &&
+             Cpu0FunctionInfo::inheritsGlobalBaseReg(*CalleeFn);
+    if (PassGP && !LongCall) {
+      Callee = DAG.getTargetGlobalAddress(G->getGlobal(), DL, PtrVT, 0,
+                                          Cpu0II::MO_NO_FLAG);
+      DirectPICCall = true;
+    } else if (IsPIC) {
+      CalleeHint = DAG.getTargetGlobalAddress(G->getGlobal(), DL, PtrVT, 0,
+                                              Cpu0II::MO_CALL_HINT);
+      if (G->getGlobal()->hasInternalLinkage())
+        Callee = getAddrLocal(G, PtrVT, DAG);
+      else if (LargeGOT)
+        Callee = getAddrGlobalLargeGOT(G, PtrVT, DAG, Cpu0II::MO_GOT_HI16,
+                                       Cpu0II::MO_GOT_LO16, Chain,
+                                       MachinePointerInfo::getGOT(MF));
+      else
+        Callee = getAddrGlobal(G, PtrVT, DAG, Cpu0II::MO_GOT_CALL, Chain,
+                               MachinePointerInfo::getGOT(MF));
+    } else if (LongCall) {
+      CalleeHint = DAG.getTargetGlobalAddress(G->getGlobal(), DL, PtrVT, 0,
+                                              Cpu0II::MO_CALL_HINT);
+      Callee = getAddrNonPIC(G, PtrVT, DAG);
+    } else
+      Callee = DAG.getTargetGlobalAddress(G->getGlobal(), DL, PtrVT, 0,
+                                          Cpu0II::MO_NO_FLAG);
+    GlobalOrExternal = !LongCall;
+  } else if (ExternalSymbolSDNode *S = dyn_cast<ExternalSymbolSDNode>(Callee)) {
+    if (IsPIC) {
+      CalleeHint = DAG.getTargetExternalSymbol(S->getSymbol(), PtrVT,
+                                               Cpu0II::MO_CALL_HINT);
+      if (LargeGOT)
+        Callee = getAddrGlobalLargeGOT(S, PtrVT, DAG, Cpu0II::MO_GOT_HI16,
+                                       Cpu0II::MO_GOT_LO16, Chain,
+                                       MachinePointerInfo::getGOT(MF));
+      else
+        Callee = getAddrGlobal(S, PtrVT, DAG, Cpu0II::MO_GOT_CALL, Chain,
+                               MachinePointerInfo::getGOT(MF));
+    } else if (LongCall) {
+      CalleeHint = DAG.getTargetExternalSymbol(S->getSymbol(), PtrVT,
+                                               Cpu0II::MO_CALL_HINT);
+      Callee = getAddrNonPIC(S, PtrVT, DAG);
+    } else
+      Callee = DAG.getTargetExternalSymbol(S->getSymbol(), PtrVT,
+                                           Cpu0II::MO_NO_FLAG);
+    GlobalOrExternal = !LongCall;
+  }
+
+  // T9 should contain the address of the callee function if
+  // -relocation-model=pic or it is an indirect or long call. Static fastcc
+  // calls may pass arguments in T9, so they jump through any register
+  // instead.
+  SmallVector<SDValue, 8> Ops(1, Chain);
+  bool UseT9 = (IsPIC && !DirectPICCall) ||
+               (!GlobalOrExternal && CallConv != CallingConv::Fast);
+  if (UseT9)
+    RegsToPass.push_front(std::make_pair((unsigned)Cpu0::T9, Callee));
+  else
+    Ops.push_back(Callee);
+
+  // Build a sequence of copy-to-reg nodes chained together with token
+  // chain and flag operands which copy the outgoing args into registers.
+  // The InFlag in necessary since all emitted instructions must be
+  // stuck together.
+  SDValue InFlag;
+  for (unsigned I = 0, E = RegsToPass.size(); I != E; ++I) {
+    Chain = DAG.getCopyToReg(Chain, DL, RegsToPass[I].first,
+                             RegsToPass[I].second, InFlag);
+    InFlag = Chain.getValue(1);
+  }
+  Ops[0] = Chain;
+
+  // Add argument registers to the end of the list so that they are
+  // known live into the call.
+  for (unsigned I = 0, E = RegsToPass.size(); I != E; ++I)
+    Ops.push_back(DAG.getRegister(RegsToPass[I].first,
+                                  RegsToPass[I].second.getValueType()));
+
+  if (PassGP)
+    Ops.push_back(getGlobalReg(DAG, PtrVT));
+
+  if (CalleeHint.getNode())
+    Ops.push_back(CalleeHint);
+
+  // Add a register mask operand representing the call-preserved registers.
+  const TargetRegisterInfo *TRI = Subtarget.getRegisterInfo();
+  const uint32_t *Mask = TRI->getCallPreservedMask(MF, CallConv);
+  assert(Mask && "Missing call preserved mask for calling convention");
+  Ops.push_back(DAG.getRegisterMask(Mask));
+
+  if (InFlag.getNode())
+    Ops.push_back(InFlag);
+
+  SDVTList NodeTys = DAG.getVTList(MVT::Other, MVT::Glue);
+  Chain = DAG.getNode(Cpu0ISD::JmpLink, DL, NodeTys, Ops);
+  InFlag = Chain.getValue(1);
+
+  // Create the CALLSEQ_END node.
+  Chain = DAG.getCALLSEQ_END(Chain,
+                             DAG.getIntPtrConstant(NextStackOffset, DL, true),
+                             DAG.getIntPtrConstant(0, DL, true), InFlag, DL);
+  InFlag = Chain.getValue(1);
+
+  // Handle result values, copying them out of physregs into vregs that we
+  // return.
+  return LowerCallResult(Chain, InFlag, CallConv, IsVarArg, Ins, DL, DAG,
+                         InVals, CLI.Callee.getNode(), CLI.RetTy);
+}
+//@LowerCall }
+
+/// LowerCallResult - Lower the result values of a call into the
+/// appropriate copies out of appropriate physical registers.
+SDValue Cpu0TargetLowering::LowerCallResult(
+    SDValue Chain, SDValue InFlag, CallingConv::ID CallConv, bool IsVarArg,
+    const SmallVectorImpl<ISD::InputArg> &Ins, const SDLoc &DL,
+    SelectionDAG &DAG, SmallVectorImpl<SDValue> &InVals,
+    const SDNode *CallNode, const Type *RetTy) const {
+  // Assign locations to each value returned by this call.
+  SmallVector<CCValAssign, 16> RVLocs;
+  CCState CCInfo(CallConv, IsVarArg, DAG.getMachineFunction(), RVLocs,
+                 *DAG.getContext());
+  Cpu0CC Cpu0CCInfo(CallConv, ABI.IsO32(), CCInfo);
+
+  Cpu0CCInfo.analyzeCallResult(Ins, Subtarget.abiUsesSoftFloat(), CallNode,
+                               RetTy);
+
+  // Copy all of the result registers out of their specified physreg.
+  for (unsigned I = 0; I != RVLocs.size(); ++I) {
+    SDValue Val = DAG.getCopyFromReg(Chain, DL, RVLocs[I].getLocReg(),
+                                     RVLocs[I].getLocVT(), InFlag);
+    Chain = Val.getValue(1);
+    InFlag = Val.getValue(2);
+
+    if (RVLocs[I].getValVT() != RVLocs[I].getLocVT())
+      Val = DAG.getNode(ISD::BITCAST, DL, RVLocs[I].getValVT(), Val);
+
+    InVals.push_back(Val);
+  }
+
+  return Chain;
+}
+
 //===----------------------------------------------------------------------===//
 //@            Formal Arguments Calling Convention Implementation
 //===----------------------------------------------------------------------===//
@@ -367,7 +1505,9 @@ SDValue Cpu0TargetLowering::LowerFormalArguments(
     const SmallVectorImpl<ISD::InputArg> &Ins, const SDLoc &DL,
     SelectionDAG &DAG, SmallVectorImpl<SDValue> &InVals) const {
   MachineFunction &MF = DAG.getMachineFunction();
+  MachineFrameInfo &MFI = MF.getFrameInfo();
   Cpu0FunctionInfo *Cpu0FI = MF.getInfo<Cpu0FunctionInfo>();
+  EVT PtrVT = getPointerTy(DAG.getDataLayout());
 
   Cpu0FI->setVarArgsFrameIndex(0);
 
@@ -377,9 +1517,99 @@ SDValue Cpu0TargetLowering::LowerFormalArguments(
                  *DAG.getContext());
   Cpu0CC Cpu0CCInfo(CallConv, ABI.IsO32(), CCInfo);
 
+  Cpu0CCInfo.analyzeFormalArguments(Ins);
   Cpu0FI->setFormalArgInfo(CCInfo.getNextStackOffset(),
                            Cpu0CCInfo.hasByValArg());
 
+  // Used with vargs to acumulate store chains.
+  std::vector<SDValue> OutChains;
+
+  for (unsigned I = 0, E = ArgLocs.size(); I != E; ++I) {
+    CCValAssign &VA = ArgLocs[I];
+    EVT ValVT = VA.getValVT();
+    ISD::ArgFlagsTy Flags = Ins[I].Flags;
+
+    //@byval pass {
+    if (Flags.isByVal()) {
+      assert(VA.isMemLoc() && "byval arguments are passed on the stack");
+      assert(Flags.getByValSize() &&
+             "ByVal args of size 0 should have been ignored by front-end.");
+      int FI = MFI.CreateFixedObject(Flags.getByValSize(),
+                                     VA.getLocMemOffset(), true);
+      InVals.push_back(DAG.getFrameIndex(FI, PtrVT));
+      continue;
+    }
+    //@byval pass }
+
+    // Arguments stored on registers
+    if (VA.isRegLoc()) {
+      MVT RegVT = VA.getLocVT();
+      Register Reg = MF.addLiveIn(VA.getLocReg(), getRegClassFor(RegVT));
+      SDValue ArgValue = DAG.getCopyFromReg(Chain, DL, Reg, RegVT);
+
+      // If this is an 8 or 16-bit value, it has been passed promoted
+      // to 32 bits.  Insert an assert[sz]ext to capture this, then
+      // truncate to the right size.
+      if (VA.getLocInfo() != CCValAssign::Full) {
+        unsigned Opcode = 0;
+        if (VA.getLocInfo() == CCValAssign::SExt)
+          Opcode = ISD::AssertSext;
+        else if (VA.getLocInfo() == CCValAssign::ZExt)
+          Opcode = ISD::AssertZext;
+        if (Opcode)
+          ArgValue = DAG.getNode(Opcode, DL, RegVT, ArgValue,
+                                 DAG.getValueType(ValVT));
+        ArgValue = DAG.getNode(ISD::TRUNCATE, DL, ValVT, ArgValue);
+      }
+
+      InVals.push_back(ArgValue);
+      continue;
+    }
+
+    // sanity check
+    assert(VA.isMemLoc());
+
+    // The stack pointer offset is relative to the caller stack frame.
+    int FI = MFI.CreateFixedObject(ValVT.getSizeInBits() / 8,
+                                   VA.getLocMemOffset(), true);
+
+    // Create load nodes to retrieve arguments from the stack
+    SDValue FIN = DAG.getFrameIndex(FI, PtrVT);
+    SDValue Load = DAG.getLoad(ValVT, DL, Chain, FIN,
+                               MachinePointerInfo::getFixedStack(MF, FI));
+    InVals.push_back(Load);
+    OutChains.push_back(Load.getValue(1));
+  }
+
+  //@Ordinary struct type: 1 {
+  // The cpu0 ABIs for returning structs by value requires that we copy
+  // the sret argument into $v0 for the return. Save the argument into
+  // a virtual register so that we can access it from the return points.
+  for (unsigned I = 0, E = ArgLocs.size(); I != E; ++I) {
+    if (!Ins[I].Flags.isSRet())
+      continue;
+
+    unsigned Reg = Cpu0FI->getSRetReturnReg();
+    if (!Reg) {
+      Reg = MF.getRegInfo().createVirtualRegister(getRegClassFor(MVT::i32));
+      Cpu0FI->setSRetReturnReg(Reg);
+    }
+    SDValue Copy = DAG.getCopyToReg(DAG.getEntryNode(), DL, Reg, InVals[I]);
+    Chain = DAG.getNode(ISD::TokenFactor, DL, MVT::Other, Copy, Chain);
+    break;
+  }
+  //@Ordinary struct type: 1 }
+
+  if (IsVarArg)
+    writeVarArgRegs(OutChains, Cpu0CCInfo, Chain, DL, DAG, CCInfo);
+
+  // All stores are grouped in one node to allow the matching between
+  // the size of Ins and InVals. This only happens when on varg functions
+  if (!OutChains.empty()) {
+    OutChains.push_back(Chain);
+    Chain = DAG.getNode(ISD::TokenFactor, DL, MVT::Other, OutChains);
+  }
+
   return Chain;
 }
 // @LowerFormalArguments }
@@ -699,6 +1929,49 @@ void Cpu0TargetLowering::LowerAsmOperandForConstraint(SDValue Op,
   TargetLowering::LowerAsmOperandForConstraint(Op, Constraint, Ops, DAG);
 }
 
+void Cpu0TargetLowering::writeVarArgRegs(std::vector<SDValue> &OutChains,
+                                         const Cpu0CC &CC, SDValue Chain,
+                                         const SDLoc &DL, SelectionDAG &DAG,
+                                         CCState &State) const {
+  ArrayRef<MCPhysReg> ArgRegs = ABI.GetVarArgRegs();
+  unsigned Idx = State.getFirstUnallocated(ArgRegs);
+  unsigned RegSizeInBytes = 4;
+  MVT RegTy = MVT::i32;
+  const TargetRegisterClass *RC = getRegClassFor(RegTy);
+  MachineFunction &MF = DAG.getMachineFunction();
+  MachineFrameInfo &MFI = MF.getFrameInfo();
+  Cpu0FunctionInfo *Cpu0FI = MF.getInfo<Cpu0FunctionInfo>();
+
+  // Offset of the first variable argument from stack pointer.
+  int VaArgOffset;
+
+  if (ArgRegs.size() == Idx)
+    VaArgOffset = alignTo(State.getNextStackOffset(), RegSizeInBytes);
+  else
+    VaArgOffset = (int)CC.reservedArgArea() -
+                  (int)(RegSizeInBytes * (ArgRegs.size() - Idx));
+
+  // Record the frame index of the first variable argument
+  // which is a value necessary to VASTART.
+  int FI = MFI.CreateFixedObject(RegSizeInBytes, VaArgOffset, true);
+  Cpu0FI->setVarArgsFrameIndex(FI);
+
+  // Copy the integer registers that have not been used for argument passing
+  // to the argument register save area. Registers holding named arguments
+  // are left alone, their home slots are never read.
+  for (unsigned I = Idx; I < ArgRegs.size();
+       ++I, VaArgOffset += RegSizeInBytes) {
+    Register Reg = MF.addLiveIn(ArgRegs[I], RC);
+    SDValue ArgValue = DAG.getCopyFromReg(Chain, DL, Reg, RegTy);
+    FI = MFI.CreateFixedObject(RegSizeInBytes, VaArgOffset, true);
+    SDValue PtrOff = DAG.getFrameIndex(FI, getPointerTy(DAG.getDataLayout()));
+    SDValue Store =
+        DAG.getStore(Chain, DL, ArgValue, PtrOff,
+                     MachinePointerInfo::getFixedStack(MF, FI));
+    OutChains.push_back(Store);
+  }
+}
+
 bool Cpu0TargetLowering::isLegalAddressingMode(const DataLayout &DL,
                                                const AddrMode &AM, Type *Ty,
                                                unsigned AS,
@@ -730,7 +2003,12 @@ bool Cpu0TargetLowering::isOffsetFoldingLegal(
 Cpu0TargetLowering::Cpu0CC::Cpu0CC(
     CallingConv::ID CC, bool IsO32_, CCState &Info,
     Cpu0CC::SpecialCallingConvType SpecialCallingConv_)
-    : CCInfo(Info), CallConv(CC), IsO32(IsO32_) {
+    : CCInfo(Info),
+      // Variadic fastcc functions keep the default convention, their
+      // variable arguments need the home area.
+      CallConv(CC == CallingConv::Fast && Info.isVarArg() ? CallingConv::C
+                                                          : CC),
+      IsO32(IsO32_) {
   // Pre-allocate reserved argument area.
   CCInfo.AllocateStack(reservedArgArea(), Align(1));
 }
@@ -772,6 +2050,47 @@ unsigned Cpu0TargetLowering::Cpu0CC::reservedArgArea() const {
   return (IsO32 && (CallConv != CallingConv::Fast)) ? 8 : 0;
 }
 
+CCAssignFn *Cpu0TargetLowering::Cpu0CC::fixedArgFn() const {
+  if (CallConv == CallingConv::Fast)
+    return CC_Cpu0_Fast;
+
+  return IsO32 ? CC_Cpu0O32 : CC_Cpu0S32;
+}
+
+void Cpu0TargetLowering::Cpu0CC::analyzeCallOperands(
+    const SmallVectorImpl<ISD::OutputArg> &Outs) const {
+  CCAssignFn *Fn = fixedArgFn();
+
+  // Variable arguments follow the same rules as fixed ones, so the callee
+  // finds them contiguous with the home slots of the argument registers.
+  for (unsigned I = 0, E = Outs.size(); I != E; ++I) {
+    MVT ArgVT = Outs[I].VT;
+    ISD::ArgFlagsTy ArgFlags = Outs[I].Flags;
+
+    if (Fn(I, ArgVT, ArgVT, CCValAssign::Full, ArgFlags, CCInfo)) {
+      errs() << "Call operand #" << I << " has unhandled type "
+             << EVT(ArgVT).getEVTString() << '\n';
+      llvm_unreachable(nullptr);
+    }
+  }
+}
+
+void Cpu0TargetLowering::Cpu0CC::analyzeFormalArguments(
+    const SmallVectorImpl<ISD::InputArg> &Ins) const {
+  CCAssignFn *Fn = fixedArgFn();
+
+  for (unsigned I = 0, E = Ins.size(); I != E; ++I) {
+    MVT ArgVT = Ins[I].VT;
+    ISD::ArgFlagsTy ArgFlags = Ins[I].Flags;
+
+    if (Fn(I, ArgVT, ArgVT, CCValAssign::Full, ArgFlags, CCInfo)) {
+      errs() << "Formal argument #" << I << " has unhandled type "
+             << EVT(ArgVT).getEVTString() << '\n';
+      llvm_unreachable(nullptr);
+    }
+  }
+}
+
 MVT Cpu0TargetLowering::Cpu0CC::getRegVT(MVT VT, bool IsSoftFloat) const {
   if (IsSoftFloat || IsO32)
     return VT;
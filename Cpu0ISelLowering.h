@@ -91,22 +91,71 @@ public:
 
   SDValue PerformDAGCombine(SDNode *N, DAGCombinerInfo &DCI) const override;
 
+  bool decomposeMulByConstant(LLVMContext &Context, EVT VT,
+                              SDValue C) const override;
+
+  bool isDesirableToCommuteWithShift(const SDNode *N,
+                                     CombineLevel Level) const override;
+
+  bool shouldFoldConstantShiftPairToMask(const SDNode *N,
+                                         CombineLevel Level) const override;
+
+  /// getJumpTableEncoding - Use $gp relative entries in PIC mode.
+  unsigned getJumpTableEncoding() const override;
+
+  bool isSuitableForJumpTable(const SwitchInst *SI, uint64_t NumCases,
+                              uint64_t Range, ProfileSummaryInfo *PSI,
+                              BlockFrequencyInfo *BFI) const override;
+
+  /// shouldInsertFencesForAtomic - Ordered atomics are monotonic accesses
+  /// between sync barriers.
+  bool shouldInsertFencesForAtomic(const Instruction *I) const override;
+
+  /// shouldExpandAtomicRMWInIR - With ll/sc every atomicrmw becomes a
+  /// cmpxchg loop.
+  AtomicExpansionKind
+  shouldExpandAtomicRMWInIR(AtomicRMWInst *AI) const override;
+
+  MachineBasicBlock *
+  EmitInstrWithCustomInserter(MachineInstr &MI,
+                              MachineBasicBlock *MBB) const override;
+
 protected:
   SDValue getGlobalReg(SelectionDAG &DAG, EVT Ty) const;
 
+  // GOT entries of data symbols are fixed at load time, so loads of them are
+  // invariant and can be hoisted, CSE'd and rematerialized. Call entries are
+  // left alone, lazy binding rewrites them.
+  static MachineMemOperand::Flags getGOTLoadFlags(unsigned Flag) {
+    if (Flag == Cpu0II::MO_GOT_CALL)
+      return MachineMemOperand::MONone;
+    return MachineMemOperand::MODereferenceable |
+           MachineMemOperand::MOInvariant;
+  }
+
   // This method creates the following nodes, which are necessary for
   // computing a local symbol's address:
   //
   // (add (load (wrapper $gp, %got(sym)), %lo(sym))
+  //
+  // %got(sym) is a 16-bit GOT offset, so the large code model loads the
+  // address with %got_hi16/%got_lo16 instead.
   template <class NodeTy>
   SDValue getAddrLocal(NodeTy *N, EVT Ty, SelectionDAG &DAG) const {
+    if (getTargetMachine().getCodeModel() == CodeModel::Large)
+      return getAddrGlobalLargeGOT(
+          N, Ty, DAG, Cpu0II::MO_GOT_HI16, Cpu0II::MO_GOT_LO16,
+          DAG.getEntryNode(),
+          MachinePointerInfo::getGOT(DAG.getMachineFunction()));
+
     SDLoc DL(N);
     unsigned GOTFlag = Cpu0II::MO_GOT;
     SDValue GOT = DAG.getNode(Cpu0ISD::Wrapper, DL, Ty, getGlobalReg(DAG, Ty),
                               getTargetNode(N, Ty, DAG, GOTFlag));
     SDValue Load =
         DAG.getLoad(Ty, DL, DAG.getEntryNode(), GOT,
-                    MachinePointerInfo::getGOT(DAG.getMachineFunction()));
+                    MachinePointerInfo::getGOT(DAG.getMachineFunction()),
+                    Align(4), getGOTLoadFlags(GOTFlag));
     unsigned LoFlag = Cpu0II::MO_ABS_LO;
     SDValue Lo =
         DAG.getNode(Cpu0ISD::Lo, DL, Ty, getTargetNode(N, Ty, DAG, LoFlag));
@@ -125,7 +174,8 @@ protected:
     SDLoc DL(N);
     SDValue Tgt = DAG.getNode(Cpu0ISD::Wrapper, DL, Ty, getGlobalReg(DAG, Ty),
                               getTargetNode(N, Ty, DAG, Flag));
-    return DAG.getLoad(Ty, DL, Chain, Tgt, PtrInfo);
+    return DAG.getLoad(Ty, DL, Chain, Tgt, PtrInfo, Align(4),
+                       getGOTLoadFlags(Flag));
   }
   //@getAddrGlobal }
 
@@ -144,7 +194,8 @@ protected:
     Hi = DAG.getNode(ISD::ADD, DL, Ty, Hi, getGlobalReg(DAG, Ty));
     SDValue Wrapper = DAG.getNode(Cpu0ISD::Wrapper, DL, Ty, Hi,
                                   getTargetNode(N, Ty, DAG, LoFlag));
-    return DAG.getLoad(Ty, DL, Chain, Wrapper, PtrInfo);
+    return DAG.getLoad(Ty, DL, Chain, Wrapper, PtrInfo, Align(4),
+                       getGOTLoadFlags(LoFlag));
   }
   //@getAddrGlobalLargeGOT }
 
@@ -180,6 +231,10 @@ protected:
     Cpu0CC(CallingConv::ID CallConv, bool IsO32, CCState &Info,
            SpecialCallingConvType SpecialCallingConv = NoSpecialCallingConv);
 
+    void analyzeCallOperands(const SmallVectorImpl<ISD::OutputArg> &Outs) const;
+
+    void analyzeFormalArguments(const SmallVectorImpl<ISD::InputArg> &Ins) const;
+
     void analyzeCallResult(const SmallVectorImpl<ISD::InputArg> &Ins,
                            bool IsSoftFloat, const SDNode *CallNode,
                            const Type *RetTy) const;
@@ -193,7 +248,7 @@ protected:
     bool hasByValArg() const { return !ByValArgs.empty(); }
 
     /// reservedArgArea - The size of the area the caller reserves for
-    /// register arguments. This is 16-byte if ABI is O32.
+    /// register arguments. This is 8-byte if ABI is O32, fastcc reserves none.
     unsigned reservedArgArea() const;
 
     using byval_iterator = SmallVectorImpl<ByValArgInfo>::const_iterator;
@@ -201,6 +256,9 @@ protected:
     byval_iterator byval_end() const { return ByValArgs.end(); }
 
   private:
+    /// Return the function that assigns locations to fixed arguments.
+    CCAssignFn *fixedArgFn() const;
+
     /// Return the type of the register which is used to pass an argument or
     /// return a value. This function returns f64 if the argument is an i64
     /// value which has been generated as a result of softening an f128 value.
@@ -246,8 +304,44 @@ private:
   SDValue lowerBlockAddress(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerJumpTable(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerGlobalAddress(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerGlobalTLSAddress(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerShiftLeftParts(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerShiftRightParts(SDValue Op, SelectionDAG &DAG, bool IsSRA) const;
+  SDValue lowerVASTART(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerVAARG(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerBSWAP(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerFunnelShift(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerXALUO(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerSETCC64(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerMINMAX(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerABS(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerATOMIC_FENCE(SDValue Op, SelectionDAG &DAG) const;
+
+  MachineBasicBlock *emitAtomicCmpSwap(MachineInstr &MI,
+                                       MachineBasicBlock *BB) const;
+
+  /// writeVarArgRegs - Write variable function arguments passed in registers
+  /// to the stack. Also create a stack frame object for the first variable
+  /// argument.
+  void writeVarArgRegs(std::vector<SDValue> &OutChains, const Cpu0CC &CC,
+                       SDValue Chain, const SDLoc &DL, SelectionDAG &DAG,
+                       CCState &State) const;
+
+  SDValue passArgOnStack(SDValue StackPtr, unsigned Offset, SDValue Chain,
+                         SDValue Arg, const SDLoc &DL,
+                         SelectionDAG &DAG) const;
+
+  // Lower the result values of a call into the appropriate copies out of
+  // appropriate physical registers.
+  SDValue LowerCallResult(SDValue Chain, SDValue InFlag,
+                          CallingConv::ID CallConv, bool IsVarArg,
+                          const SmallVectorImpl<ISD::InputArg> &Ins,
+                          const SDLoc &DL, SelectionDAG &DAG,
+                          SmallVectorImpl<SDValue> &InVals,
+                          const SDNode *CallNode, const Type *RetTy) const;
+
+  SDValue LowerCall(TargetLowering::CallLoweringInfo &CLI,
+                    SmallVectorImpl<SDValue> &InVals) const override;
 
   //- must be exist even without function all
   SDValue LowerFormalArguments(SDValue Chain, CallingConv::ID CallConv,
@@ -13,6 +13,7 @@
 
 #include "Cpu0MachineFunction.h"
 #include "Cpu0TargetMachine.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
@@ -24,6 +25,7 @@
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/DebugLoc.h"
+#include "llvm/IR/Module.h"
 #include "llvm/MC/MCInstrDesc.h"
 #include "llvm/Target/TargetMachine.h"
 #include <cassert>
@@ -36,7 +38,9 @@ using namespace llvm;
 // Pin the vtable to this file
 void Cpu0InstrInfo::anchor() {}
 
-Cpu0InstrInfo::Cpu0InstrInfo(const Cpu0Subtarget &STI) : Subtarget(STI) {}
+Cpu0InstrInfo::Cpu0InstrInfo(const Cpu0Subtarget &STI)
+    : Cpu0GenInstrInfo(Cpu0::ADJCALLSTACKDOWN, Cpu0::ADJCALLSTACKUP),
+      Subtarget(STI) {}
 
 const Cpu0InstrInfo *Cpu0InstrInfo::create(Cpu0Subtarget &STI) {
   return llvm::createCpu0SEInstrInfo(STI);
@@ -65,3 +69,124 @@ Cpu0InstrInfo::GetMemOperand(MachineBasicBlock &MBB, int FI,
                                  Flags, MFI.getObjectSize(FI),
                                  MFI.getObjectAlign(FI));
 }
+
+//@MachineOutliner {
+// Outlined sequences are called with "jsub" and return with "ret $lr".
+enum MachineOutlinerConstructionID { MachineOutlinerDefault };
+
+bool Cpu0InstrInfo::isFunctionSafeToOutlineFrom(
+    MachineFunction &MF, bool OutlineFromLinkOnceODRs) const {
+  const Function &F = MF.getFunction();
+
+  // Can F be deduplicated by the linker? If it can, don't outline from it.
+  if (!OutlineFromLinkOnceODRs && F.hasLinkOnceODRLinkage())
+    return false;
+
+  // Don't outline from functions with section markings; the program could
+  // expect that all the code is in the named section.
+  if (F.hasSection())
+    return false;
+
+  // Outlined functions are called with jsub, which the large code model, or
+  // the medium one from a section other than .text, can't rely on. This
+  // matches needsLongCall in Cpu0ISelLowering.cpp.
+  const TargetMachine &TM = MF.getTarget();
+  if (TM.getCodeModel() == CodeModel::Large ||
+      (TM.getCodeModel() == CodeModel::Medium &&
+       (TM.getFunctionSections() || F.hasComdat())))
+    return false;
+
+  // Candidates are checked against $lr liveness.
+  return MF.getRegInfo().tracksLiveness();
+}
+
+// Without -enable-machine-outliner, only minsize (-Oz) functions are
+// outlined from.
+bool Cpu0InstrInfo::shouldOutlineFromFunctionByDefault(
+    MachineFunction &MF) const {
+  return MF.getFunction().hasMinSize();
+}
+
+outliner::OutlinedFunction Cpu0InstrInfo::getOutliningCandidateInfo(
+    std::vector<outliner::Candidate> &RepeatedSequenceLocs) const {
+  // jsub overwrites $lr, so it must not be live across the candidate.
+  const TargetRegisterInfo &TRI = getRegisterInfo();
+  llvm::erase_if(RepeatedSequenceLocs, [&TRI](outliner::Candidate &C) {
+    C.initLRU(TRI);
+    return !C.LRU.available(Cpu0::LR);
+  });
+
+  // If the sequence doesn't have enough candidates left, then we're done.
+  if (RepeatedSequenceLocs.size() < 2)
+    return outliner::OutlinedFunction();
+
+  unsigned SequenceSize = 0;
+  for (auto I = RepeatedSequenceLocs[0].front(),
+            E = std::next(RepeatedSequenceLocs[0].back());
+       I != E; ++I)
+    SequenceSize += GetInstSizeInBytes(*I);
+
+  // jsub at each call site, ret $lr at the end of the outlined function.
+  unsigned CallOverhead = get(Cpu0::JSUB).getSize();
+  unsigned FrameOverhead = get(Cpu0::RET).getSize();
+  for (outliner::Candidate &C : RepeatedSequenceLocs)
+    C.setCallInfo(MachineOutlinerDefault, CallOverhead);
+
+  return outliner::OutlinedFunction(RepeatedSequenceLocs, SequenceSize,
+                                    FrameOverhead, MachineOutlinerDefault);
+}
+
+outliner::InstrType
+Cpu0InstrInfo::getOutliningType(MachineBasicBlock::iterator &MBBI,
+                                unsigned Flags) const {
+  MachineInstr &MI = *MBBI;
+  const TargetRegisterInfo &TRI = getRegisterInfo();
+
+  // Don't allow instructions which won't be materialized to impact outlining
+  // analysis.
+  if (MI.isMetaInstruction())
+    return outliner::InstrType::Invisible;
+
+  // Don't trust the user to write safe inline assembly.
+  if (MI.isInlineAsm())
+    return outliner::InstrType::Illegal;
+
+  // Branches and returns stay in place. A bundle is a branch together with
+  // its filled delay slot, which must not be split either.
+  if (MI.isTerminator() || MI.isReturn() || MI.isBundled())
+    return outliner::InstrType::Illegal;
+
+  // Calls and long branches clobber $lr, which holds the return address of
+  // the outlined function; anything reading $lr would see that address.
+  if (MI.isCall() || MI.readsRegister(Cpu0::LR, &TRI) ||
+      MI.modifiesRegister(Cpu0::LR, &TRI))
+    return outliner::InstrType::Illegal;
+
+  // Labels and CFI describe positions in this function only.
+  if (MI.isPosition())
+    return outliner::InstrType::Illegal;
+
+  // Make sure the operands don't reference something unsafe.
+  for (const MachineOperand &MO : MI.operands())
+    if (MO.isMBB() || MO.isBlockAddress() || MO.isCPI() || MO.isJTI())
+      return outliner::InstrType::Illegal;
+
+  return outliner::InstrType::Legal;
+}
+
+void Cpu0InstrInfo::buildOutlinedFrame(
+    MachineBasicBlock &MBB, MachineFunction &MF,
+    const outliner::OutlinedFunction &OF) const {
+  MBB.addLiveIn(Cpu0::LR);
+  MBB.insert(MBB.end(),
+             BuildMI(MF, DebugLoc(), get(Cpu0::RET)).addReg(Cpu0::LR));
+}
+
+MachineBasicBlock::iterator Cpu0InstrInfo::insertOutlinedCall(
+    Module &M, MachineBasicBlock &MBB, MachineBasicBlock::iterator &It,
+    MachineFunction &MF, const outliner::Candidate &C) const {
+  It = MBB.insert(It, BuildMI(MF, DebugLoc(), get(Cpu0::JSUB))
+                          .addGlobalAddress(M.getNamedValue(MF.getName())));
+  return It;
+}
+//@MachineOutliner }
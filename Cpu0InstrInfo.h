@@ -13,15 +13,17 @@
 #define LLVM_LIB_TARGET_CPU0_CPU0INSTRINFO_H
 
 #include "Cpu0.h"
-#include "Cpu0AnalyzeImmediate.h"
 #include "Cpu0RegisterInfo.h"
+#include "MCTargetDesc/Cpu0AnalyzeImmediate.h"
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineMemOperand.h"
+#include "llvm/CodeGen/MachineOutliner.h"
 #include "llvm/CodeGen/TargetInstrInfo.h"
 #include <cstdint>
+#include <vector>
 
 #define GET_INSTRINFO_HEADER
 #include "Cpu0GenInstrInfo.inc"
@@ -82,6 +84,27 @@ public:
                               MachineBasicBlock &MBB,
                               MachineBasicBlock::iterator I) const = 0;
 
+  /// MachineOutliner hooks. An outlined sequence is called with jsub and
+  /// returns with ret $lr, so $lr must be dead around every candidate.
+  bool isFunctionSafeToOutlineFrom(MachineFunction &MF,
+                                   bool OutlineFromLinkOnceODRs) const override;
+
+  bool shouldOutlineFromFunctionByDefault(MachineFunction &MF) const override;
+
+  outliner::OutlinedFunction getOutliningCandidateInfo(
+      std::vector<outliner::Candidate> &RepeatedSequenceLocs) const override;
+
+  outliner::InstrType getOutliningType(MachineBasicBlock::iterator &MBBI,
+                                       unsigned Flags) const override;
+
+  void buildOutlinedFrame(MachineBasicBlock &MBB, MachineFunction &MF,
+                          const outliner::OutlinedFunction &OF) const override;
+
+  MachineBasicBlock::iterator
+  insertOutlinedCall(Module &M, MachineBasicBlock &MBB,
+                     MachineBasicBlock::iterator &It, MachineFunction &MF,
+                     const outliner::Candidate &C) const override;
+
 protected:
   MachineMemOperand *GetMemOperand(MachineBasicBlock &MBB, int FI,
                                    MachineMemOperand::Flags Flags) const;
@@ -52,6 +52,9 @@ MCOperand Cpu0MCInstLower::LowerSymbolOperand(const MachineOperand &MO,
   case Cpu0II::MO_GOT:
     TargetKind = Cpu0MCExpr::CEK_GOT;
     break;
+  case Cpu0II::MO_GOT_CALL:
+    TargetKind = Cpu0MCExpr::CEK_GOT_CALL;
+    break;
     // ABS_HI and ABS_LO is for llc -march=cpu0 -relocation-model=static (global
     //  var in .data).
   case Cpu0II::MO_ABS_HI:
@@ -66,6 +69,18 @@ MCOperand Cpu0MCInstLower::LowerSymbolOperand(const MachineOperand &MO,
   case Cpu0II::MO_GOT_LO16:
     TargetKind = Cpu0MCExpr::CEK_GOT_LO16;
     break;
+  case Cpu0II::MO_TLSGD:
+    TargetKind = Cpu0MCExpr::CEK_TLSGD;
+    break;
+  case Cpu0II::MO_GOTTPREL:
+    TargetKind = Cpu0MCExpr::CEK_GOTTPREL;
+    break;
+  case Cpu0II::MO_TP_HI:
+    TargetKind = Cpu0MCExpr::CEK_TP_HI;
+    break;
+  case Cpu0II::MO_TP_LO:
+    TargetKind = Cpu0MCExpr::CEK_TP_LO;
+    break;
   }
 
   switch (MOTy) {
@@ -78,6 +93,11 @@ MCOperand Cpu0MCInstLower::LowerSymbolOperand(const MachineOperand &MO,
     Symbol = MO.getMBB()->getSymbol();
     break;
 
+  case MachineOperand::MO_ExternalSymbol:
+    Symbol = AsmPrinter.GetExternalSymbolSymbol(MO.getSymbolName());
+    Offset += MO.getOffset();
+    break;
+
   case MachineOperand::MO_BlockAddress:
     Symbol = AsmPrinter.GetBlockAddressSymbol(MO.getBlockAddress());
     Offset += MO.getOffset();
@@ -87,6 +107,11 @@ MCOperand Cpu0MCInstLower::LowerSymbolOperand(const MachineOperand &MO,
     Symbol = AsmPrinter.GetJTISymbol(MO.getIndex());
     break;
 
+  case MachineOperand::MO_ConstantPoolIndex:
+    Symbol = AsmPrinter.GetCPISymbol(MO.getIndex());
+    Offset += MO.getOffset();
+    break;
+
   default:
     llvm_unreachable("<unknown operand type>");
   }
@@ -155,10 +180,16 @@ MCOperand Cpu0MCInstLower::LowerOperand(const MachineOperand &MO,
     return MCOperand::createReg(MO.getReg());
   case MachineOperand::MO_Immediate:
     return MCOperand::createImm(MO.getImm() + offset);
+  case MachineOperand::MO_GlobalAddress:
+  case MachineOperand::MO_ExternalSymbol:
+    // The callee hint of an indirect call only exists for IPRA.
+    if (MO.getTargetFlags() == Cpu0II::MO_CALL_HINT)
+      break;
+    return LowerSymbolOperand(MO, MOTy, offset);
   case MachineOperand::MO_MachineBasicBlock:
   case MachineOperand::MO_JumpTableIndex:
+  case MachineOperand::MO_ConstantPoolIndex:
   case MachineOperand::MO_BlockAddress:
-  case MachineOperand::MO_GlobalAddress:
     return LowerSymbolOperand(MO, MOTy, offset);
   case MachineOperand::MO_RegisterMask:
     break;
@@ -16,11 +16,11 @@
 
 using namespace llvm;
 
-bool FixGlobalBaseReg;
-
 Cpu0FunctionInfo::~Cpu0FunctionInfo() {}
 
-bool Cpu0FunctionInfo::globalBaseRegFixed() const { return FixGlobalBaseReg; }
+bool Cpu0FunctionInfo::globalBaseRegFixed() const {
+  return MF.getSubtarget<Cpu0Subtarget>().fixGlobalBaseReg();
+}
 
 bool Cpu0FunctionInfo::globalBaseRegSet() const { return GlobalBaseReg; }
 
@@ -28,6 +28,10 @@ unsigned Cpu0FunctionInfo::getGlobalBaseReg() {
   return GlobalBaseReg = Cpu0::GP;
 }
 
+bool Cpu0FunctionInfo::inheritsGlobalBaseReg(const Function &F) {
+  return F.hasLocalLinkage() && !F.hasAddressTaken();
+}
+
 void Cpu0FunctionInfo::createEhDataRegsFI() {
   const TargetRegisterInfo &TRI = *MF.getSubtarget().getRegisterInfo();
   for (int I = 0; I < 2; ++I) {
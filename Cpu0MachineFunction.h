@@ -39,6 +39,12 @@ public:
   bool globalBaseRegSet() const;
   unsigned getGlobalBaseReg();
 
+  /// inheritsGlobalBaseReg - Whether F is only reached by direct calls from
+  /// its own module. In PIC mode such a function is called with jsub, so $t9
+  /// does not hold its address; it takes $gp from the caller instead of
+  /// computing it with .cpload.
+  static bool inheritsGlobalBaseReg(const Function &F);
+
   int getVarArgsFrameIndex() const { return VarArgsFrameIndex; }
   void setVarArgsFrameIndex(int Index) { VarArgsFrameIndex = Index; }
 
@@ -0,0 +1,253 @@
+// Copyright 2022 All Rights Reserved.
+// Author: lanzongwei541@gmail.com (lanzongwei)
+//
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//===----------------------------------------------------------------------===//
+//
+// On cpu032I every conditional jump tests $sw, which is set by a CMP/CMPu.
+// After register allocation this pass tracks which compare $sw still holds,
+// within and across basic blocks, and deletes a compare that recomputes it:
+//
+//   cmp $sw, $2, $3
+//   jlt $sw, $BB0_2
+// $BB0_1:
+//   cmp $sw, $2, $3     <- removed
+//   jgt $sw, $BB0_3
+//
+//===----------------------------------------------------------------------===//
+
+#include "Cpu0.h"
+#include "Cpu0InstrInfo.h"
+#include "Cpu0Subtarget.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/TargetRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "cpu0-redundant-cmp-elim"
+
+STATISTIC(NumCmpsRemoved, "Number of redundant compares removed");
+
+namespace {
+
+/// The compare whose result $sw currently holds. Opc == 0 means unknown.
+struct CmpState {
+  unsigned Opc = 0;
+  Register LHS, RHS;
+
+  bool operator==(const CmpState &O) const {
+    return Opc == O.Opc && LHS == O.LHS && RHS == O.RHS;
+  }
+  bool operator!=(const CmpState &O) const { return !(*this == O); }
+};
+
+class Cpu0RedundantCmpElim : public MachineFunctionPass {
+public:
+  static char ID;
+
+  Cpu0RedundantCmpElim() : MachineFunctionPass(ID) {
+    initializeCpu0RedundantCmpElimPass(*PassRegistry::getPassRegistry());
+  }
+
+  StringRef getPassName() const override {
+    return "Cpu0 Redundant Compare Elimination";
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().set(
+        MachineFunctionProperties::Property::NoVRegs);
+  }
+
+private:
+  CmpState getInState(const MachineBasicBlock &MBB) const;
+  CmpState transfer(MachineBasicBlock &MBB, CmpState State,
+                    SmallVectorImpl<MachineInstr *> *Redundant) const;
+  void addSWLiveIn(MachineBasicBlock &MBB) const;
+
+  const TargetRegisterInfo *TRI;
+  // Compare held in $sw at the end of each block visited so far.
+  DenseMap<const MachineBasicBlock *, CmpState> OutState;
+};
+
+} // end of anonymous namespace
+
+char Cpu0RedundantCmpElim::ID = 0;
+
+INITIALIZE_PASS(Cpu0RedundantCmpElim, DEBUG_TYPE,
+                "Cpu0 Redundant Compare Elimination", false, false)
+
+FunctionPass *llvm::createCpu0RedundantCmpElim() {
+  return new Cpu0RedundantCmpElim();
+}
+
+static bool isCmp(const MachineInstr &MI) {
+  return MI.getOpcode() == Cpu0::CMP || MI.getOpcode() == Cpu0::CMPu;
+}
+
+/// $sw is known on entry only if every visited predecessor leaves the same
+/// compare in it. Predecessors not visited yet (back edges) are ignored until
+/// the iteration reaches them.
+CmpState Cpu0RedundantCmpElim::getInState(const MachineBasicBlock &MBB) const {
+  CmpState In;
+  bool First = true;
+
+  if (MBB.pred_empty() || MBB.isEHPad())
+    return CmpState();
+
+  for (const MachineBasicBlock *Pred : MBB.predecessors()) {
+    auto It = OutState.find(Pred);
+    if (It == OutState.end())
+      continue;
+    if (First) {
+      In = It->second;
+      First = false;
+    } else if (In != It->second) {
+      return CmpState();
+    }
+  }
+
+  return In;
+}
+
+/// Walk MBB starting with State in $sw and return the state at its end. If
+/// Redundant is not null, collect the compares that recompute $sw.
+CmpState Cpu0RedundantCmpElim::transfer(
+    MachineBasicBlock &MBB, CmpState State,
+    SmallVectorImpl<MachineInstr *> *Redundant) const {
+  for (MachineInstr &MI : MBB) {
+    if (MI.isDebugInstr())
+      continue;
+
+    if (isCmp(MI) && MI.getOperand(0).getReg() == Cpu0::SW) {
+      CmpState New;
+      New.Opc = MI.getOpcode();
+      New.LHS = MI.getOperand(1).getReg();
+      New.RHS = MI.getOperand(2).getReg();
+
+      if (State.Opc && State == New) {
+        if (Redundant)
+          Redundant->push_back(&MI);
+        continue;
+      }
+
+      State = New;
+      continue;
+    }
+
+    // Any other write to $sw (including a call clobbering it) or to a
+    // compared register makes the tracked compare stale.
+    if (MI.modifiesRegister(Cpu0::SW, TRI) ||
+        (State.Opc && (MI.modifiesRegister(State.LHS, TRI) ||
+                       MI.modifiesRegister(State.RHS, TRI))))
+      State = CmpState();
+  }
+
+  return State;
+}
+
+/// $sw now lives into MBB. Propagate that to predecessors which only pass the
+/// value through.
+void Cpu0RedundantCmpElim::addSWLiveIn(MachineBasicBlock &MBB) const {
+  SmallVector<MachineBasicBlock *, 8> WorkList(1, &MBB);
+
+  while (!WorkList.empty()) {
+    MachineBasicBlock *BB = WorkList.pop_back_val();
+    if (BB->isLiveIn(Cpu0::SW))
+      continue;
+    BB->addLiveIn(Cpu0::SW);
+    BB->sortUniqueLiveIns();
+
+    for (MachineBasicBlock *Pred : BB->predecessors()) {
+      bool DefinesSW = false;
+      for (const MachineInstr &MI : *Pred)
+        if (MI.modifiesRegister(Cpu0::SW, TRI)) {
+          DefinesSW = true;
+          break;
+        }
+      if (!DefinesSW)
+        WorkList.push_back(Pred);
+    }
+  }
+}
+
+bool Cpu0RedundantCmpElim::runOnMachineFunction(MachineFunction &MF) {
+  const Cpu0Subtarget &STI = MF.getSubtarget<Cpu0Subtarget>();
+  if (skipFunction(MF.getFunction()) || !STI.hasCmp())
+    return false;
+
+  TRI = STI.getRegisterInfo();
+  OutState.clear();
+
+  // Forward data flow to a fixed point; a block's state can only go from
+  // a known compare to unknown, so this terminates.
+  ReversePostOrderTraversal<MachineFunction *> RPOT(&MF);
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (MachineBasicBlock *MBB : RPOT) {
+      CmpState Out = transfer(*MBB, getInState(*MBB), nullptr);
+      auto It = OutState.find(MBB);
+      if (It == OutState.end() || It->second != Out) {
+        OutState[MBB] = Out;
+        Changed = true;
+      }
+    }
+  }
+
+  bool Removed = false;
+  for (MachineBasicBlock *MBB : RPOT) {
+    SmallVector<MachineInstr *, 4> Redundant;
+    transfer(*MBB, getInState(*MBB), &Redundant);
+    if (Redundant.empty())
+      continue;
+
+    // A compare reused from a predecessor makes $sw live into this block.
+    bool LiveIn = true;
+    for (MachineInstr &MI : *MBB) {
+      if (&MI == Redundant.front())
+        break;
+      if (MI.modifiesRegister(Cpu0::SW, TRI)) {
+        LiveIn = false;
+        break;
+      }
+    }
+    if (LiveIn)
+      addSWLiveIn(*MBB);
+
+    for (MachineInstr *MI : Redundant) {
+      LLVM_DEBUG(dbgs() << "Removing redundant compare: " << *MI);
+      MI->eraseFromParent();
+      ++NumCmpsRemoved;
+    }
+    Removed = true;
+  }
+
+  if (!Removed)
+    return false;
+
+  // The kept compares now reach further; drop flags that say otherwise.
+  for (MachineBasicBlock &MBB : MF)
+    for (MachineInstr &MI : MBB)
+      for (MachineOperand &MO : MI.operands()) {
+        if (!MO.isReg() || MO.getReg() != Cpu0::SW)
+          continue;
+        if (MO.isUse())
+          MO.setIsKill(false);
+        else if (isCmp(MI))
+          MO.setIsDead(false);
+      }
+
+  return true;
+}
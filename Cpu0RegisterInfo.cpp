@@ -65,7 +65,8 @@ Cpu0RegisterInfo::getCallPreservedMask(const MachineFunction &MF,
 BitVector Cpu0RegisterInfo::getReservedRegs(const MachineFunction &MF) const {
   //@getReservedRegs body {
   static const uint16_t ReservedCPURegs[] = {Cpu0::ZERO, Cpu0::AT, Cpu0::SP,
-                                             Cpu0::LR, /*Cpu0::SW, */ Cpu0::PC};
+                                             Cpu0::LR, /*Cpu0::SW, */ Cpu0::PC,
+                                             Cpu0::TP};
   BitVector Reserved(getNumRegs());
 
   for (unsigned I = 0; I < array_lengthof(ReservedCPURegs); ++I)
@@ -73,14 +74,38 @@ BitVector Cpu0RegisterInfo::getReservedRegs(const MachineFunction &MF) const {
 
 #ifdef ENABLE_GPRESTORE // 1
   const Cpu0FunctionInfo *Cpu0FI = MF.getInfo<Cpu0FunctionInfo>();
-  // Reserve GP if globalBaseRegFixed()
-  if (Cpu0FI->globalBaseRegFixed())
+  // Reserve GP whenever this function addresses the GOT or small data
+  // through it, and otherwise if globalBaseRegFixed(). In PIC mode each
+  // function loads GP itself (.cpload) or inherits it from a direct caller,
+  // so GP is free unless used. Static small data relies on the GP set up at
+  // startup, keep it reserved.
+  if (Cpu0FI->globalBaseRegSet() ||
+      (Cpu0FI->globalBaseRegFixed() &&
+       (MF.getSubtarget<Cpu0Subtarget>().reserveGP() ||
+        !MF.getTarget().isPositionIndependent())))
 #endif
     Reserved.set(Cpu0::GP);
 
+  // Reserve FP only if this function keeps a frame pointer.
+  if (MF.getSubtarget().getFrameLowering()->hasFP(MF))
+    Reserved.set(Cpu0::FP);
+
   return Reserved;
 }
 
+// $zero always reads as 0, so instructions reading it (e.g. "addiu $r, $zero,
+// imm") stay trivially rematerializable.
+bool Cpu0RegisterInfo::isConstantPhysReg(MCRegister PhysReg) const {
+  return PhysReg == Cpu0::ZERO;
+}
+
+// In PIC mode $gp is reloaded after every call that may change it, so its
+// uses keep seeing the same value and GOT loads stay invariant.
+bool Cpu0RegisterInfo::isCallerPreservedPhysReg(
+    MCRegister PhysReg, const MachineFunction &MF) const {
+  return PhysReg == Cpu0::GP && MF.getTarget().isPositionIndependent();
+}
+
 //@eliminateFrameIndex {
 //- If no eliminateFrameIndex(), it will hang on run.
 // pure virtual method
@@ -104,6 +129,15 @@ void Cpu0RegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
              errs() << "<--------->\n"
                     << MI);
 
+  const std::vector<CalleeSavedInfo> &CSI = MFI.getCalleeSavedInfo();
+  int MinCSFI = 0;
+  int MaxCSFI = -1;
+
+  if (CSI.size()) {
+    MinCSFI = CSI[0].getFrameIdx();
+    MaxCSFI = CSI[CSI.size() - 1].getFrameIdx();
+  }
+
   int FrameIndex = MI.getOperand(i).getIndex();
   uint64_t stackSize = MF.getFrameInfo().getStackSize();
   int64_t spOffset = MF.getFrameInfo().getObjectOffset(FrameIndex);
@@ -118,9 +152,14 @@ void Cpu0RegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
   //  3. Locations for callee-saved registers.
   // Everything else is referenced relative to whatever register
   // getFrameRegister() returns.
+  // The callee-saved registers are stored before $fp is set up and reloaded
+  // after $sp is restored from it, but $fp == $sp in between.
   unsigned FrameReg;
 
-  FrameReg = Cpu0::SP;
+  if (FrameIndex >= MinCSFI && FrameIndex <= MaxCSFI)
+    FrameReg = Cpu0::SP;
+  else
+    FrameReg = getFrameRegister(MF);
 
   // Calculate final offset.
   // - There is no need to change the offset if the frame object is one of the
@@ -11,12 +11,13 @@
 
 #include "Cpu0SEFrameLowering.h"
 
-#include "Cpu0AnalyzeImmediate.h"
 #include "Cpu0MachineFunction.h"
 #include "Cpu0SEInstrInfo.h"
 #include "Cpu0Subtarget.h"
+#include "MCTargetDesc/Cpu0AnalyzeImmediate.h"
 
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
@@ -41,6 +42,7 @@
 #include "llvm/Support/MathExtras.h"
 #include <cassert>
 #include <cstdint>
+#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -59,6 +61,8 @@ void Cpu0SEFrameLowering::emitPrologue(MachineFunction &MF,
   MachineBasicBlock::iterator MBBI = MBB.begin();
   DebugLoc dl = MBBI != MBB.end() ? MBBI->getDebugLoc() : DebugLoc();
   unsigned SP = Cpu0::SP;
+  unsigned FP = Cpu0::FP;
+  unsigned ZERO = Cpu0::ZERO;
 
   // First, compute final stack size.
   uint64_t StackSize = MFI.getStackSize();
@@ -103,6 +107,21 @@ void Cpu0SEFrameLowering::emitPrologue(MachineFunction &MF,
       }
     }
   }
+
+  // if framepointer enabled, set it to point to the stack pointer.
+  if (hasFP(MF)) {
+    // Insert instruction "addu $fp, $sp, $zero" at this location.
+    BuildMI(MBB, MBBI, dl, TII.get(Cpu0::ADDu), FP)
+        .addReg(SP)
+        .addReg(ZERO)
+        .setMIFlag(MachineInstr::FrameSetup);
+
+    // emit ".cfi_def_cfa_register $fp"
+    unsigned CFIIndex = MF.addFrameInst(MCCFIInstruction::createDefCfaRegister(
+        nullptr, MRI->getDwarfRegNum(FP, true)));
+    BuildMI(MBB, MBBI, dl, TII.get(TargetOpcode::CFI_INSTRUCTION))
+        .addCFIIndex(CFIIndex);
+  }
 }
 
 void Cpu0SEFrameLowering::emitEpilogue(MachineFunction &MF,
@@ -115,6 +134,20 @@ void Cpu0SEFrameLowering::emitEpilogue(MachineFunction &MF,
 
   DebugLoc DL = MBBI != MBB.end() ? MBBI->getDebugLoc() : DebugLoc();
   unsigned SP = Cpu0::SP;
+  unsigned FP = Cpu0::FP;
+  unsigned ZERO = Cpu0::ZERO;
+
+  // if framepointer enabled, restore the stack pointer.
+  if (hasFP(MF)) {
+    // Find the first instruction that restores a callee-saved register.
+    MachineBasicBlock::iterator I = MBBI;
+
+    for (unsigned i = 0; i < MFI.getCalleeSavedInfo().size(); ++i)
+      --I;
+
+    // Insert instruction "addu $sp, $fp, $zero" at this location.
+    BuildMI(MBB, I, DL, TII.get(Cpu0::ADDu), SP).addReg(FP).addReg(ZERO);
+  }
 
   // Get the number of bytes from FrameInfo
   uint64_t StackSize = MFI.getStackSize();
@@ -138,6 +171,25 @@ bool Cpu0SEFrameLowering::hasReservedCallFrame(
          !MFI.hasVarSizedObjects();
 }
 
+// Eliminate ADJCALLSTACKDOWN, ADJCALLSTACKUP pseudo instructions
+MachineBasicBlock::iterator Cpu0SEFrameLowering::eliminateCallFramePseudoInstr(
+    MachineFunction &MF, MachineBasicBlock &MBB,
+    MachineBasicBlock::iterator I) const {
+  const Cpu0SEInstrInfo &TII =
+      *static_cast<const Cpu0SEInstrInfo *>(STI.getInstrInfo());
+
+  if (!hasReservedCallFrame(MF)) {
+    int64_t Amount = I->getOperand(0).getImm();
+
+    if (I->getOpcode() == Cpu0::ADJCALLSTACKDOWN)
+      Amount = -Amount;
+
+    TII.adjustStackPtr(Cpu0::SP, Amount, MBB, I);
+  }
+
+  return MBB.erase(I);
+}
+
 /// Mark \p Reg and all registers aliasing it in the bitset.
 static void setAliasRegs(MachineFunction &MF, BitVector &SavedRegs,
                          unsigned Reg) {
@@ -152,14 +204,58 @@ static void setAliasRegs(MachineFunction &MF, BitVector &SavedRegs,
 void Cpu0SEFrameLowering::determineCalleeSaves(MachineFunction &MF,
                                                BitVector &SavedRegs,
                                                RegScavenger *RS) const {
+  // With -enable-ipra the base class leaves SavedRegs empty for local
+  // functions; their callers learn what is clobbered from the regmask the
+  // RegUsageInfoCollector records, so nothing but LR has to be saved here.
   TargetFrameLowering::determineCalleeSaves(MF, SavedRegs, RS);
 
+  // Mark $fp as used if function has dedicated frame pointer.
+  if (hasFP(MF))
+    setAliasRegs(MF, SavedRegs, Cpu0::FP);
+
+  // LR holds our return address and every jsub/jalr overwrites it.
   if (MF.getFrameInfo().hasCalls())
     setAliasRegs(MF, SavedRegs, Cpu0::LR);
 
   return;
 }
 
+// The PIC equivalent of .cprestore. A callee reached through $t9 may live in
+// another module and return with the $gp its own .cpload computed, so a
+// function using $gp saves it to a stack slot on entry and reloads it after
+// each such call. This runs after register allocation: before it $gp has no
+// defs, so GOT loads stay invariant for LICM, CSE and rematerialization, and
+// the callee-saved register scan doesn't spill $gp either.
+void Cpu0SEFrameLowering::processFunctionBeforeFrameFinalized(
+    MachineFunction &MF, RegScavenger *RS) const {
+  Cpu0FunctionInfo *Cpu0FI = MF.getInfo<Cpu0FunctionInfo>();
+  if (!MF.getTarget().isPositionIndependent() || !Cpu0FI->globalBaseRegSet())
+    return;
+
+  SmallVector<MachineInstr *, 8> Calls;
+  for (MachineBasicBlock &MBB : MF)
+    for (MachineInstr &MI : MBB)
+      if (MI.isCall() && MI.getOpcode() != Cpu0::JSUB)
+        Calls.push_back(&MI);
+  if (Calls.empty())
+    return;
+
+  const TargetInstrInfo &TII = *STI.getInstrInfo();
+  const TargetRegisterInfo *TRI = STI.getRegisterInfo();
+  const TargetRegisterClass &RC = Cpu0::CPURegsRegClass;
+  int FI = MF.getFrameInfo().CreateStackObject(4, Align(4), false);
+
+  // The prologue is inserted in front of this store.
+  MachineBasicBlock &Entry = MF.front();
+  TII.storeRegToStackSlot(Entry, Entry.begin(), Cpu0::GP, false, FI, &RC,
+                          TRI);
+
+  for (MachineInstr *MI : Calls)
+    TII.loadRegFromStackSlot(*MI->getParent(),
+                             std::next(MachineBasicBlock::iterator(MI)),
+                             Cpu0::GP, FI, &RC, TRI);
+}
+
 const Cpu0FrameLowering *
 llvm::createCpu0SEFrameLowering(const Cpu0Subtarget &ST) {
   return new Cpu0SEFrameLowering(ST);
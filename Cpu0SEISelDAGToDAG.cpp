@@ -12,9 +12,9 @@
 #include "Cpu0SEISelDAGToDAG.h"
 
 #include "Cpu0.h"
-#include "Cpu0AnalyzeImmediate.h"
 #include "Cpu0MachineFunction.h"
 #include "Cpu0RegisterInfo.h"
+#include "MCTargetDesc/Cpu0AnalyzeImmediate.h"
 #include "MCTargetDesc/Cpu0BaseInfo.h"
 #include "llvm/CodeGen/MachineConstantPool.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
@@ -27,6 +27,7 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/Type.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -35,6 +36,12 @@ using namespace llvm;
 
 #define DEBUG_TYPE "cpu0-isel"
 
+static cl::opt<bool> GPRelConstantPool(
+    "cpu0-gprel-constant-pool", cl::Hidden, cl::init(false),
+    cl::desc("In optsize functions, load 32-bit constants that take more "
+             "than one instruction to build from a gp-relative constant "
+             "pool (.srodata)"));
+
 bool Cpu0SEDAGToDAGISel::runOnMachineFunction(MachineFunction &MF) {
   Subtarget = &MF.getSubtarget<Cpu0Subtarget>();
   return Cpu0DAGToDAGISel::runOnMachineFunction(MF);
@@ -89,6 +96,46 @@ void Cpu0SEDAGToDAGISel::selectAddESubE(unsigned MOp, SDValue InFlag,
   CurDAG->SelectNodeTo(Node, MOp, VT, MVT::Glue, LHS, SDValue(AddCarry, 0));
 }
 
+/// Replace a 32-bit constant with "ld $r, %gp_rel(cst)($gp)" in optsize
+/// functions when the LUi/ORi style sequence has more than one instruction;
+/// the pool entry is shared by all uses in the function. A load is never
+/// faster than the at most two ALU instructions building a 32-bit value, so
+/// other functions keep the sequence. Only in static mode with small
+/// sections, where $gp is set up at startup.
+bool Cpu0SEDAGToDAGISel::selectConstantPoolLoad(SDNode *Node) {
+  if (!GPRelConstantPool || Subtarget->isPositionIndependent() ||
+      !Subtarget->useSmallSection())
+    return false;
+
+  MachineFunction &MF = CurDAG->getMachineFunction();
+  if (!MF.getFunction().hasOptSize())
+    return false;
+
+  const ConstantSDNode *CN = cast<ConstantSDNode>(Node);
+  if (AnalyzeImm.Analyze(CN->getSExtValue(), 32, false).size() < 2)
+    return false;
+
+  SDLoc DL(Node);
+  SDValue CPIdx = CurDAG->getTargetConstantPool(
+      CN->getConstantIntValue(), MVT::i32, Align(4), 0, Cpu0II::MO_GPREL);
+  Register GP = MF.getInfo<Cpu0FunctionInfo>()->getGlobalBaseReg();
+  SDValue Ops[] = {CurDAG->getRegister(GP, MVT::i32), CPIdx,
+                   CurDAG->getEntryNode()};
+  MachineSDNode *Ld =
+      CurDAG->getMachineNode(Cpu0::LD, DL, MVT::i32, MVT::Other, Ops);
+
+  MachineMemOperand *MMO = MF.getMachineMemOperand(
+      MachinePointerInfo::getConstantPool(MF),
+      MachineMemOperand::MOLoad | MachineMemOperand::MOInvariant |
+          MachineMemOperand::MODereferenceable,
+      4, Align(4));
+  CurDAG->setNodeMemRefs(Ld, {MMO});
+
+  ReplaceUses(SDValue(Node, 0), SDValue(Ld, 0));
+  CurDAG->RemoveDeadNode(Node);
+  return true;
+}
+
 //@selectNode
 bool Cpu0SEDAGToDAGISel::trySelect(SDNode *Node) {
   unsigned Opcode = Node->getOpcode();
@@ -152,8 +199,11 @@ bool Cpu0SEDAGToDAGISel::trySelect(SDNode *Node) {
     const ConstantSDNode *CN = dyn_cast<ConstantSDNode>(Node);
     unsigned Size = CN->getValueSizeInBits(0);
 
-    if (Size == 32)
+    if (Size == 32) {
+      if (selectConstantPoolLoad(Node))
+        return true;
       break;
+    }
 
     return true;
   }
@@ -13,6 +13,7 @@
 #define LLVM_LIB_TARGET_CPU0_CPU0SEISELDAGTODAG_H
 
 #include "Cpu0ISelDAGToDAG.h"
+#include "MCTargetDesc/Cpu0AnalyzeImmediate.h"
 
 namespace llvm {
 
@@ -39,6 +40,10 @@ private:
 
   void selectAddESubE(unsigned MOp, SDValue InFlag, SDValue CmpLHS,
                       const SDLoc &DL, SDNode *Node) const;
+
+  bool selectConstantPoolLoad(SDNode *Node);
+
+  Cpu0AnalyzeImmediate AnalyzeImm;
 };
 
 FunctionPass *createCpu0SEISelDag(Cpu0TargetMachine &TM,
@@ -15,6 +15,7 @@
 #include "Cpu0TargetMachine.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/MC/TargetRegistry.h"
@@ -23,6 +24,13 @@
 
 using namespace llvm;
 
+#define DEBUG_TYPE "cpu0-instr-info"
+
+STATISTIC(NumSpills, "Number of registers stored to a stack slot");
+STATISTIC(NumReloads, "Number of registers loaded from a stack slot");
+STATISTIC(NumFoldedSpills, "Number of moves folded into a spill");
+STATISTIC(NumFoldedReloads, "Number of moves folded into a reload");
+
 Cpu0SEInstrInfo::Cpu0SEInstrInfo(const Cpu0Subtarget &STI)
     : Cpu0InstrInfo(STI), RI(STI) {}
 
@@ -32,6 +40,125 @@ const Cpu0InstrInfo *llvm::createCpu0SEInstrInfo(const Cpu0Subtarget &STI) {
   return new Cpu0SEInstrInfo(STI);
 }
 
+static bool isZeroImm(const MachineOperand &Op) {
+  return Op.isImm() && Op.getImm() == 0;
+}
+
+/// isLoadFromStackSlot - If the specified machine instruction is a direct
+/// load from a stack slot, return the virtual or physical register number of
+/// the destination along with the FrameIndex of the loaded stack slot.  If
+/// not, return 0.  This predicate must return 0 if the instruction has
+/// any side effects other than loading from the stack slot.
+unsigned Cpu0SEInstrInfo::isLoadFromStackSlot(const MachineInstr &MI,
+                                              int &FrameIndex) const {
+  if (MI.getOpcode() == Cpu0::LD && MI.getOperand(1).isFI() &&
+      isZeroImm(MI.getOperand(2))) {
+    FrameIndex = MI.getOperand(1).getIndex();
+    return MI.getOperand(0).getReg();
+  }
+
+  return 0;
+}
+
+/// isStoreToStackSlot - If the specified machine instruction is a direct
+/// store to a stack slot, return the virtual or physical register number of
+/// the source reg along with the FrameIndex of the loaded stack slot.  If
+/// not, return 0.  This predicate must return 0 if the instruction has
+/// any side effects other than storing to the stack slot.
+unsigned Cpu0SEInstrInfo::isStoreToStackSlot(const MachineInstr &MI,
+                                             int &FrameIndex) const {
+  if (MI.getOpcode() == Cpu0::ST && MI.getOperand(1).isFI() &&
+      isZeroImm(MI.getOperand(2))) {
+    FrameIndex = MI.getOperand(1).getIndex();
+    return MI.getOperand(0).getReg();
+  }
+
+  return 0;
+}
+
+/// If \p MI only moves one register into another ("addu $d, $zero, $s",
+/// "addu $d, $s, $zero" or "addiu $d, $s, 0"), return the operand index of
+/// the source register, otherwise 0.
+static unsigned getMoveSrcOpIdx(const MachineInstr &MI) {
+  switch (MI.getOpcode()) {
+  default:
+    break;
+  case Cpu0::ADDu:
+    if (MI.getOperand(1).getReg() == Cpu0::ZERO)
+      return 2;
+    if (MI.getOperand(2).getReg() == Cpu0::ZERO)
+      return 1;
+    break;
+  case Cpu0::ADDiu:
+    if (MI.getOperand(1).isReg() && isZeroImm(MI.getOperand(2)))
+      return 1;
+    break;
+  }
+
+  return 0;
+}
+
+/// If the specific machine instruction is an instruction that moves/copies
+/// value from one register to another register return destination and source
+/// registers as machine operands.
+Optional<DestSourcePair>
+Cpu0SEInstrInfo::isCopyInstrImpl(const MachineInstr &MI) const {
+  if (unsigned SrcIdx = getMoveSrcOpIdx(MI))
+    return DestSourcePair{MI.getOperand(0), MI.getOperand(SrcIdx)};
+  return None;
+}
+
+/// "addiu $d, $s, imm" adds an immediate to a register.
+Optional<RegImmPair> Cpu0SEInstrInfo::isAddImmediate(const MachineInstr &MI,
+                                                     Register Reg) const {
+  if (MI.getOpcode() != Cpu0::ADDiu)
+    return None;
+
+  const MachineOperand &Op0 = MI.getOperand(0);
+  const MachineOperand &Op1 = MI.getOperand(1);
+  const MachineOperand &Op2 = MI.getOperand(2);
+  if (Op0.getReg() != Reg || !Op1.isReg() || !Op2.isImm())
+    return None;
+
+  return RegImmPair{Op1.getReg(), Op2.getImm()};
+}
+
+/// Fold a spilled move: storing its result becomes a store of its source and
+/// reloading its source becomes a load of its result.
+MachineInstr *Cpu0SEInstrInfo::foldMemoryOperandImpl(
+    MachineFunction &MF, MachineInstr &MI, ArrayRef<unsigned> Ops,
+    MachineBasicBlock::iterator InsertPt, int FrameIndex, LiveIntervals *LIS,
+    VirtRegMap *VRM) const {
+  unsigned SrcIdx = getMoveSrcOpIdx(MI);
+  if (!SrcIdx || Ops.size() != 1)
+    return nullptr;
+
+  MachineBasicBlock &MBB = *InsertPt->getParent();
+  const MachineOperand &DstMO = MI.getOperand(0);
+  const MachineOperand &SrcMO = MI.getOperand(SrcIdx);
+
+  // The memory operand is attached by TargetInstrInfo::foldMemoryOperand.
+  if (Ops[0] == 0) {
+    ++NumFoldedSpills;
+    return BuildMI(MBB, InsertPt, MI.getDebugLoc(), get(Cpu0::ST))
+        .addReg(SrcMO.getReg(), getKillRegState(SrcMO.isKill()) |
+                                    getUndefRegState(SrcMO.isUndef()))
+        .addFrameIndex(FrameIndex)
+        .addImm(0);
+  }
+
+  if (Ops[0] == SrcIdx) {
+    ++NumFoldedReloads;
+    return BuildMI(MBB, InsertPt, MI.getDebugLoc(), get(Cpu0::LD))
+        .addReg(DstMO.getReg(),
+                RegState::Define | getDeadRegState(DstMO.isDead()))
+        .addFrameIndex(FrameIndex)
+        .addImm(0);
+  }
+
+  return nullptr;
+}
+
 void Cpu0SEInstrInfo::copyPhysReg(MachineBasicBlock &MBB,
                                   MachineBasicBlock::iterator I,
                                   const DebugLoc &DL, MCRegister DestReg,
@@ -75,6 +202,9 @@ bool Cpu0SEInstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
   case Cpu0::RetLR:
     expandRetLR(MBB, MI);
     break;
+  case Cpu0::LUiORi:
+    expandLUiORi(MBB, MI);
+    break;
   }
 
   MBB.erase(MI);
@@ -86,6 +216,18 @@ void Cpu0SEInstrInfo::expandRetLR(MachineBasicBlock &MBB,
   BuildMI(MBB, I, I->getDebugLoc(), get(Cpu0::RET)).addReg(Cpu0::LR);
 }
 
+void Cpu0SEInstrInfo::expandLUiORi(MachineBasicBlock &MBB,
+                                   MachineBasicBlock::iterator I) const {
+  const DebugLoc &DL = I->getDebugLoc();
+  Register DstReg = I->getOperand(0).getReg();
+  uint64_t Imm = I->getOperand(1).getImm();
+
+  BuildMI(MBB, I, DL, get(Cpu0::LUi), DstReg).addImm((Imm >> 16) & 0xffff);
+  BuildMI(MBB, I, DL, get(Cpu0::ORi), DstReg)
+      .addReg(DstReg, RegState::Kill)
+      .addImm(Imm & 0xffff);
+}
+
 void Cpu0SEInstrInfo::storeRegToStack(MachineBasicBlock &MBB,
                                       MachineBasicBlock::iterator I,
                                       Register SrcReg, bool isKill, int FI,
@@ -99,6 +241,7 @@ void Cpu0SEInstrInfo::storeRegToStack(MachineBasicBlock &MBB,
 
   Opc = Cpu0::ST;
   assert(Opc && "Register class not handled!");
+  ++NumSpills;
   BuildMI(MBB, I, DL, get(Opc))
       .addReg(SrcReg, getKillRegState(isKill))
       .addFrameIndex(FI)
@@ -120,6 +263,7 @@ void Cpu0SEInstrInfo::loadRegFromStack(MachineBasicBlock &MBB,
 
   Opc = Cpu0::LD;
   assert(Opc && "Register class not handled!");
+  ++NumReloads;
   BuildMI(MBB, I, DL, get(Opc), DestReg)
       .addFrameIndex(FI)
       .addImm(Offset)
@@ -143,13 +287,19 @@ void Cpu0SEInstrInfo::adjustStackPtr(unsigned SP, int64_t Amount,
   }
 }
 
+/// ADDiu takes a signed immediate; ORi, XORi and SHL take unsigned ones.
+static int64_t getImmOperand(const Cpu0AnalyzeImmediate::Inst &I) {
+  if (I.Opc == Cpu0::ADDiu)
+    return SignExtend64<16>(I.ImmOpnd);
+  return I.ImmOpnd;
+}
+
 /// This function generates the sequence of instructions needed to get the
 /// result of adding register REG and immediate IMM.
 unsigned Cpu0SEInstrInfo::loadImmediate(int64_t Imm, MachineBasicBlock &MBB,
                                         MachineBasicBlock::iterator II,
                                         const DebugLoc &DL,
                                         unsigned *NewImm) const {
-  Cpu0AnalyzeImmediate AnalyzeImm;
   unsigned Size = 32;
   unsigned LUi = Cpu0::LUi;
   unsigned ZEROReg = Cpu0::ZERO;
@@ -171,13 +321,13 @@ unsigned Cpu0SEInstrInfo::loadImmediate(int64_t Imm, MachineBasicBlock &MBB,
   else
     BuildMI(MBB, II, DL, get(Inst->Opc), ATReg)
         .addReg(ZEROReg)
-        .addImm(SignExtend64<16>(Inst->ImmOpnd));
+        .addImm(getImmOperand(*Inst));
 
   // Build the remaining instructions in Seq.
   for (++Inst; Inst != Seq.end() - LastInstrIsADDiu; ++Inst)
     BuildMI(MBB, II, DL, get(Inst->Opc), ATReg)
         .addReg(ATReg)
-        .addImm(SignExtend64<16>(Inst->ImmOpnd));
+        .addImm(getImmOperand(*Inst));
 
   if (LastInstrIsADDiu)
     *NewImm = Inst->ImmOpnd;
@@ -185,6 +335,106 @@ unsigned Cpu0SEInstrInfo::loadImmediate(int64_t Imm, MachineBasicBlock &MBB,
   return ATReg;
 }
 
+/// analyzeCompare - CMP and CMPu compare two registers into $sw.
+bool Cpu0SEInstrInfo::analyzeCompare(const MachineInstr &MI, Register &SrcReg,
+                                     Register &SrcReg2, int64_t &CmpMask,
+                                     int64_t &CmpValue) const {
+  switch (MI.getOpcode()) {
+  default:
+    return false;
+  case Cpu0::CMP:
+  case Cpu0::CMPu:
+    SrcReg = MI.getOperand(1).getReg();
+    SrcReg2 = MI.getOperand(2).getReg();
+    CmpMask = ~0;
+    CmpValue = 0;
+    return true;
+  }
+}
+
+/// Return the conditional jump that tests the same condition on $sw after
+/// the compared operands are swapped, e.g. JLT to JGT, or 0 if \p Opc is not
+/// a conditional jump on $sw.
+static unsigned getSwappedCondBranchOpc(unsigned Opc) {
+  switch (Opc) {
+  default:
+    return 0;
+  case Cpu0::JEQ:
+    return Cpu0::JEQ;
+  case Cpu0::JNE:
+    return Cpu0::JNE;
+  case Cpu0::JLT:
+    return Cpu0::JGT;
+  case Cpu0::JGT:
+    return Cpu0::JLT;
+  case Cpu0::JLE:
+    return Cpu0::JGE;
+  case Cpu0::JGE:
+    return Cpu0::JLE;
+  }
+}
+
+/// optimizeCompareInstr - Remove a compare whose operands were already
+/// compared, in the same or swapped order, by the previous compare in the
+/// block. Swapped uses must all be conditional jumps, which get their
+/// condition swapped.
+bool Cpu0SEInstrInfo::optimizeCompareInstr(
+    MachineInstr &CmpInstr, Register SrcReg, Register SrcReg2, int64_t CmpMask,
+    int64_t CmpValue, const MachineRegisterInfo *MRI) const {
+  Register CmpReg = CmpInstr.getOperand(0).getReg();
+  if (!CmpReg.isVirtual())
+    return false;
+
+  // Only look at the closest compare above, reusing anything further up
+  // would keep two $sw values live at the same time. Calls clobber $sw.
+  MachineBasicBlock::iterator I = CmpInstr;
+  MachineBasicBlock::iterator B = CmpInstr.getParent()->begin();
+  MachineInstr *PrevCmp = nullptr;
+  while (I != B) {
+    --I;
+    if (I->isCall())
+      return false;
+    if (I->isCompare()) {
+      PrevCmp = &*I;
+      break;
+    }
+  }
+
+  if (!PrevCmp || PrevCmp->getOpcode() != CmpInstr.getOpcode())
+    return false;
+
+  Register PrevReg = PrevCmp->getOperand(0).getReg();
+  Register PrevLHS = PrevCmp->getOperand(1).getReg();
+  Register PrevRHS = PrevCmp->getOperand(2).getReg();
+  bool Swapped;
+
+  if (PrevLHS == SrcReg && PrevRHS == SrcReg2)
+    Swapped = false;
+  else if (PrevLHS == SrcReg2 && PrevRHS == SrcReg)
+    Swapped = true;
+  else
+    return false;
+
+  if (!PrevReg.isVirtual())
+    return false;
+
+  MachineRegisterInfo &RegInfo = CmpInstr.getMF()->getRegInfo();
+
+  if (Swapped) {
+    for (MachineInstr &UseMI : RegInfo.use_nodbg_instructions(CmpReg))
+      if (!getSwappedCondBranchOpc(UseMI.getOpcode()))
+        return false;
+
+    for (MachineInstr &UseMI : RegInfo.use_nodbg_instructions(CmpReg))
+      UseMI.setDesc(get(getSwappedCondBranchOpc(UseMI.getOpcode())));
+  }
+
+  RegInfo.replaceRegWith(CmpReg, PrevReg);
+  RegInfo.clearKillFlags(PrevReg);
+  CmpInstr.eraseFromParent();
+  return true;
+}
+
 /// getOppositeBranchOpc - Return the inverse of the specified
 /// opcode, e.g. turning BEQ to BNE.
 unsigned Cpu0SEInstrInfo::getOppositeBranchOpc(unsigned Opc) const {
@@ -19,12 +19,40 @@ namespace llvm {
 
 class Cpu0SEInstrInfo : public Cpu0InstrInfo {
   const Cpu0SERegisterInfo RI;
+  /// Caches immediate sequences across loadImmediate calls.
+  mutable Cpu0AnalyzeImmediate AnalyzeImm;
 
 public:
   explicit Cpu0SEInstrInfo(const Cpu0Subtarget &STI);
 
   const Cpu0RegisterInfo &getRegisterInfo() const override;
 
+  unsigned isLoadFromStackSlot(const MachineInstr &MI,
+                               int &FrameIndex) const override;
+
+  unsigned isStoreToStackSlot(const MachineInstr &MI,
+                              int &FrameIndex) const override;
+
+  Optional<RegImmPair> isAddImmediate(const MachineInstr &MI,
+                                      Register Reg) const override;
+
+  bool analyzeCompare(const MachineInstr &MI, Register &SrcReg,
+                      Register &SrcReg2, int64_t &CmpMask,
+                      int64_t &CmpValue) const override;
+
+  bool optimizeCompareInstr(MachineInstr &CmpInstr, Register SrcReg,
+                            Register SrcReg2, int64_t CmpMask,
+                            int64_t CmpValue,
+                            const MachineRegisterInfo *MRI) const override;
+
+  using TargetInstrInfo::foldMemoryOperandImpl;
+  MachineInstr *
+  foldMemoryOperandImpl(MachineFunction &MF, MachineInstr &MI,
+                        ArrayRef<unsigned> Ops,
+                        MachineBasicBlock::iterator InsertPt, int FrameIndex,
+                        LiveIntervals *LIS = nullptr,
+                        VirtRegMap *VRM = nullptr) const override;
+
   void copyPhysReg(MachineBasicBlock &MBB, MachineBasicBlock::iterator MI,
                    const DebugLoc &DL, MCRegister DestReg, MCRegister SrcReg,
                    bool KillSrc) const override;
@@ -54,9 +82,17 @@ public:
                          MachineBasicBlock::iterator II, const DebugLoc &DL,
                          unsigned *NewImm) const;
 
+protected:
+  /// Recognize the ADDu/ADDiu forms copyPhysReg and isel use for moves.
+  Optional<DestSourcePair>
+  isCopyInstrImpl(const MachineInstr &MI) const override;
+
 private:
   void expandRetLR(MachineBasicBlock &MBB, MachineBasicBlock::iterator I) const;
 
+  void expandLUiORi(MachineBasicBlock &MBB,
+                    MachineBasicBlock::iterator I) const;
+
   unsigned getOppositeBranchOpc(unsigned Opc) const override;
 };
 } // namespace llvm
@@ -31,6 +31,11 @@ using namespace llvm;
 #define GET_SUBTARGETINFO_CTOR
 #include "Cpu0GenSubtargetInfo.inc"
 
+// These options only turn on the default of the matching subtarget feature
+// (+overflow, +small-section, +reserve-gp, +no-cpload), which -mattr and the
+// "target-features" function attribute can set per function, see
+// addOptionFeatures; +small-section must be the same for the whole module.
+// They are read, never written, so concurrent code generation can share them.
 static cl::opt<bool>
     EnableOverflowOpt("cpu0-enable-overflow", cl::Hidden, cl::init(false),
                       cl::desc("Use trigger overflow instructions add and sub \
@@ -47,10 +52,21 @@ static cl::opt<bool> ReserveGPOpt("cpu0-reserve-gp", cl::Hidden,
 static cl::opt<bool> NoCploadOpt("cpu0-no-cpload", cl::Hidden, cl::init(false),
                                  cl::desc("No issue .cpload"));
 
-bool Cpu0ReserveGP;
-bool Cpu0NoCpload;
-
-extern bool FixGlobalBaseReg;
+/// Put the features turned on by options in front of FS. The generated
+/// parser only ever sets feature members to true, so this way a "-feature"
+/// in FS still turns off an option's default.
+static std::string addOptionFeatures(StringRef FS) {
+  std::string Features;
+  if (EnableOverflowOpt)
+    Features += "+overflow,";
+  if (UseSmallSectionOpt)
+    Features += "+small-section,";
+  if (ReserveGPOpt)
+    Features += "+reserve-gp,";
+  if (NoCploadOpt)
+    Features += "+no-cpload,";
+  return Features + FS.str();
+}
 
 void Cpu0Subtarget::anchor() {}
 
@@ -58,24 +74,12 @@ Cpu0Subtarget::Cpu0Subtarget(const Triple &TT, StringRef CPU, StringRef FS,
                              bool little, const Cpu0TargetMachine &_TM)
     : // Cpu0GenSubtargetInfo will display features by llc -march=cpu0
       // -mcpu=help
-      Cpu0GenSubtargetInfo(TT, CPU, /*TuneCPU*/ CPU, FS), IsLittle(little),
-      TM(_TM), TargetTriple(TT), TSInfo(),
-      InstrInfo(
-          Cpu0InstrInfo::create(initializeSubtargetDependencies(CPU, FS, TM))),
+      Cpu0GenSubtargetInfo(TT, CPU, /*TuneCPU*/ CPU, addOptionFeatures(FS)),
+      IsLittle(little), TM(_TM), TargetTriple(TT), TSInfo(),
+      InstrInfo(Cpu0InstrInfo::create(
+          initializeSubtargetDependencies(CPU, addOptionFeatures(FS), TM))),
       FrameLowering(Cpu0FrameLowering::create(*this)),
-      TLInfo(Cpu0TargetLowering::create(TM, *this)) {
-  EnableOverflow = EnableOverflowOpt;
-  // Set UseSmallSection.
-  UseSmallSection = UseSmallSectionOpt;
-  Cpu0ReserveGP = ReserveGPOpt;
-  Cpu0NoCpload = NoCploadOpt;
-#ifdef ENABLE_GPRESTORE
-  if (!TM.isPositionIndependent() && !UseSmallSection && !Cpu0ReserveGP)
-    FixGlobalBaseReg = false;
-  else
-#endif
-    FixGlobalBaseReg = true;
-}
+      TLInfo(Cpu0TargetLowering::create(TM, *this)) {}
 
 bool Cpu0Subtarget::isPositionIndependent() const {
   return TM.isPositionIndependent();
@@ -116,10 +120,23 @@ Cpu0Subtarget::initializeSubtargetDependencies(StringRef CPU, StringRef FS,
            << "\n";
   }
 
+  HasLLSC = false;
+  EnableOverflow = false;
+  UseSmallSection = false;
+  ReserveGP = false;
+  NoCpload = false;
+
   stackAlignment = Align(8);
 
   // Parse features string.
   ParseSubtargetFeatures(CPU, /*TuneCPU*/ CPU, FS);
+
+#ifdef ENABLE_GPRESTORE
+  FixGlobalBaseReg =
+      TM.isPositionIndependent() || UseSmallSection || ReserveGP;
+#else
+  FixGlobalBaseReg = true;
+#endif
   // Initialize scheduling itinerary for the specified CPU.
   InstrItins = getInstrItineraryForCPU(CPU);
 
@@ -25,9 +25,6 @@
 #define GET_SUBTARGETINFO_HEADER
 #include "Cpu0GenSubtargetInfo.inc"
 
-extern bool Cpu0ReserveGP;
-extern bool Cpu0NoCpload;
-
 namespace llvm {
 class StringRef;
 
@@ -54,9 +51,23 @@ protected:
   // HasSlt - slt instructions.
   bool HasSlt;
 
-  // UseSmallSection - Small section is used.
+  // HasLLSC - ll/sc instructions, not implied by any cpu.
+  bool HasLLSC;
+
+  // UseSmallSection - Small section is used. The same for every function of
+  // a module, see Cpu0TargetMachine::getSubtargetImpl.
   bool UseSmallSection;
 
+  // ReserveGP - $gp is never allocated to a variable.
+  bool ReserveGP;
+
+  // NoCpload - No .cpload is emitted, the environment sets up $gp.
+  bool NoCpload;
+
+  // FixGlobalBaseReg - $gp holds the global base register, see
+  // Cpu0RegisterInfo::getReservedRegs.
+  bool FixGlobalBaseReg;
+
   Align stackAlignment;
 
   InstrItineraryData InstrItins;
@@ -96,7 +107,11 @@ public:
   bool disableOverflow() const { return !EnableOverflow; }
   bool hasCmp() const { return HasCmp; }
   bool hasSlt() const { return HasSlt; }
+  bool hasLLSC() const { return HasLLSC; }
   bool useSmallSection() const { return UseSmallSection; }
+  bool reserveGP() const { return ReserveGP; }
+  bool noCpload() const { return NoCpload; }
+  bool fixGlobalBaseReg() const { return FixGlobalBaseReg; }
 
   bool abiUsesSoftFloat() const;
 
@@ -32,6 +32,7 @@
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetOptions.h"
 #include <string>
@@ -49,6 +50,7 @@ extern "C" LLVM_EXTERNAL_VISIBILITY void LLVMInitializeCpu0Target() {
 
   PassRegistry *PR = PassRegistry::getPassRegistry();
   initializeCpu0BranchExpansionPass(*PR);
+  initializeCpu0RedundantCmpElimPass(*PR);
 }
 
 static std::string computeDataLayout(const Triple &TT, StringRef CPU,
@@ -83,6 +85,19 @@ static Reloc::Model getEffectiveRelocModel(bool JIT,
     return Reloc::Static;
   return *RM;
 }
+
+// -mcmodel picks the code model, small by default. Medium calls what jsub may
+// not reach through %hi/%lo and jalr, large also does so for every call and,
+// in PIC mode, reaches all GOT entries with %got_hi16/%got_lo16.
+static CodeModel::Model
+getEffectiveCpu0CodeModel(Optional<CodeModel::Model> CM) {
+  if (CM && (*CM == CodeModel::Tiny || *CM == CodeModel::Kernel))
+    report_fatal_error("Cpu0 only supports the small, medium and large code "
+                       "models",
+                       false);
+  return getEffectiveCodeModel(CM, CodeModel::Small);
+}
+
 // DataLayout --> Big-endian, 32-bit pointer/ABI/alignment
 // The stack is always 8 byte aligned
 // On function prologue, the stack is created by decrementing
@@ -98,11 +113,15 @@ Cpu0TargetMachine::Cpu0TargetMachine(const Target &T, const Triple &TT,
                                      bool isLittle)
     : LLVMTargetMachine(T, computeDataLayout(TT, CPU, Options, isLittle), TT,
                         CPU, FS, Options, getEffectiveRelocModel(JIT, RM),
-                        getEffectiveCodeModel(CM, CodeModel::Small), OL),
+                        getEffectiveCpu0CodeModel(CM), OL),
       isLittle(isLittle), TLOF(std::make_unique<Cpu0TargetObjectFile>()),
       ABI(Cpu0ABIInfo::computeTargetABI()),
       DefaultSubtarget(TT, CPU, FS, isLittle, *this) {
   initAsmInfo();
+
+  // Outline from minsize (-Oz) functions by default.
+  setMachineOutliner(true);
+  setSupportsDefaultOutlining(true);
 }
 
 Cpu0TargetMachine::~Cpu0TargetMachine() = default;
@@ -144,6 +163,12 @@ Cpu0TargetMachine::getSubtargetImpl(const Function &F) const {
     // function that reside in TargetOptions.
     resetTargetOptions(F);
     I = std::make_unique<Cpu0Subtarget>(TargetTriple, CPU, FS, isLittle, *this);
+    // Small sections decide where the module's globals and constants go and
+    // how every function addresses them, so they can't differ per function.
+    if (I->useSmallSection() != DefaultSubtarget.useSmallSection())
+      report_fatal_error("Function '" + F.getName() +
+                             "' disagrees with the module on small-section",
+                         false);
   }
   return I.get();
 }
@@ -184,6 +209,8 @@ bool Cpu0PassConfig::addInstSelector() {
 // machine code is emitted. return true if -print-machineinstrs should
 // print out the code after the passes.
 void Cpu0PassConfig::addPreEmitPass() {
+  if (getOptLevel() != CodeGenOpt::None)
+    addPass(createCpu0RedundantCmpElim());
   addPass(createCpu0BranchExpansion());
   return;
 }
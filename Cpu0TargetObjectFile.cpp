@@ -8,14 +8,23 @@
 
 #include "Cpu0Subtarget.h"
 #include "Cpu0TargetMachine.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/BinaryFormat/ELF.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCSectionELF.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Target/TargetMachine.h"
+#include <algorithm>
+#include <utility>
 using namespace llvm;
 
 static cl::opt<unsigned> SSThreshold(
@@ -23,6 +32,19 @@ static cl::opt<unsigned> SSThreshold(
     cl::desc("Small data and bss section threshold size (default=8)"),
     cl::init(8));
 
+// Other modules only see the threshold, so it still decides for externally
+// visible globals. With a budget, local globals are instead ranked by use and
+// packed into this module's share of the 64KB gp window. Every object file
+// gets the whole budget, so the budgets of all objects built with it, plus
+// their threshold-sized globals, must fit in 64KB: e.g. 64KB divided by the
+// number of such objects, less some headroom.
+static cl::opt<unsigned> SSBudget(
+    "cpu0-ssection-budget", cl::Hidden,
+    cl::desc("Bytes of the gp window a module may fill with its most "
+             "frequently accessed local globals (default=0, use the "
+             "threshold)"),
+    cl::init(0));
+
 void Cpu0TargetObjectFile::Initialize(MCContext &Ctx, const TargetMachine &TM) {
   TargetLoweringObjectFileELF::Initialize(Ctx, TM);
   InitializeELF(TM.Options.UseInitArray);
@@ -32,6 +54,9 @@ void Cpu0TargetObjectFile::Initialize(MCContext &Ctx, const TargetMachine &TM) {
 
   SmallBSSSection = getContext().getELFSection(".sbss", ELF::SHT_NOBITS,
                                                ELF::SHF_WRITE | ELF::SHF_ALLOC);
+
+  SmallRODataSection = getContext().getELFSection(".srodata", ELF::SHT_PROGBITS,
+                                                  ELF::SHF_ALLOC);
   this->TM = &static_cast<const Cpu0TargetMachine &>(TM);
 }
 
@@ -42,6 +67,79 @@ static bool IsInSmallSection(uint64_t Size) {
   return Size > 0 && Size <= SSThreshold;
 }
 
+/// Whether Name is one of the small sections, which is how an extern says
+/// that its definition is addressed with gp_rel.
+static bool IsSmallSectionName(StringRef Name) {
+  for (StringRef Prefix : {".sdata", ".sbss", ".srodata"})
+    if (Name.startswith(Prefix) &&
+        (Name.size() == Prefix.size() || Name[Prefix.size()] == '.'))
+      return true;
+  return false;
+}
+
+/// Estimate how often GV is accessed: one per instruction using it, scaled
+/// by the profile entry count of the function holding the instruction.
+static uint64_t getAccessCount(const GlobalVariable &GV) {
+  uint64_t Count = 0;
+  SmallVector<const User *, 8> WorkList(GV.users());
+
+  while (!WorkList.empty()) {
+    const User *U = WorkList.pop_back_val();
+    if (const auto *I = dyn_cast<Instruction>(U)) {
+      auto EntryCount = I->getFunction()->getEntryCount();
+      Count = SaturatingAdd<uint64_t>(
+          Count, EntryCount ? std::max<uint64_t>(EntryCount->getCount(), 1)
+                            : 1);
+    } else if (isa<ConstantExpr>(U)) {
+      WorkList.append(U->user_begin(), U->user_end());
+    }
+  }
+
+  return Count;
+}
+
+void Cpu0TargetObjectFile::analyzeModule(const Module &M,
+                                         const TargetMachine &TM) const {
+  if (ModuleAnalyzed)
+    return;
+  ModuleAnalyzed = true;
+  SmallLocals.clear();
+
+  const DataLayout &DL = M.getDataLayout();
+  SmallVector<std::pair<uint64_t, const GlobalVariable *>, 16> Candidates;
+  for (const GlobalVariable &GV : M.globals()) {
+    if (!GV.hasLocalLinkage() || GV.isDeclaration() || GV.hasSection())
+      continue;
+    SectionKind Kind = getKindForGlobal(&GV, TM);
+    if (!Kind.isData() && !Kind.isBSS() && !Kind.isReadOnly())
+      continue;
+    uint64_t Size = DL.getTypeAllocSize(GV.getValueType());
+    if (!Size || Size > SSBudget)
+      continue;
+    if (uint64_t Count = getAccessCount(GV))
+      Candidates.push_back(std::make_pair(Count, &GV));
+  }
+
+  // Most accessed first, the smaller of equally accessed globals first.
+  llvm::stable_sort(Candidates, [&](const auto &A, const auto &B) {
+    if (A.first != B.first)
+      return A.first > B.first;
+    return DL.getTypeAllocSize(A.second->getValueType()) <
+           DL.getTypeAllocSize(B.second->getValueType());
+  });
+
+  uint64_t Used = 0;
+  for (const auto &C : Candidates) {
+    const GlobalVariable *GV = C.second;
+    uint64_t Start = alignTo(Used, DL.getPreferredAlign(GV));
+    uint64_t End = Start + DL.getTypeAllocSize(GV->getValueType());
+    if (End > SSBudget)
+      continue;
+    Used = End;
+    SmallLocals.insert(GV);
+  }
+}
+
 bool Cpu0TargetObjectFile::IsGlobalInSmallSection(
     const GlobalObject *GO, const TargetMachine &TM) const {
   // We first check the case where global is a declaration, because finding
@@ -80,6 +178,17 @@ bool Cpu0TargetObjectFile::IsGlobalInSmallSectionImpl(
   if (!GVA)
     return false;
 
+  // An explicit section decides, for definitions and declarations alike.
+  if (GVA->hasSection())
+    return IsSmallSectionName(GVA->getSection());
+
+  // Only this module accesses its local globals, so they can be picked by
+  // use instead of size.
+  if (SSBudget && GVA->hasLocalLinkage() && !GVA->isDeclaration()) {
+    analyzeModule(*GVA->getParent(), TM);
+    return SmallLocals.count(GVA);
+  }
+
   Type *Ty = GV->getValueType();
   return IsInSmallSection(
       GV->getParent()->getDataLayout().getTypeAllocSize(Ty));
@@ -96,8 +205,31 @@ MCSection *Cpu0TargetObjectFile::SelectSectionForGlobal(
   if (Kind.isData() && IsGlobalInSmallSection(GO, TM, Kind))
     return SmallDataSection;
   if (Kind.isReadOnly() && IsGlobalInSmallSection(GO, TM, Kind))
-    return SmallDataSection;
+    return SmallRODataSection;
 
   // Otherwise, we work the same as ELF.
   return TargetLoweringObjectFileELF::SelectSectionForGlobal(GO, Kind, TM);
 }
+
+/// Return true if this constant should be placed into small data section.
+bool Cpu0TargetObjectFile::IsConstantInSmallSection(
+    const DataLayout &DL, const Constant *CN, const TargetMachine &TM) const {
+  return (static_cast<const Cpu0TargetMachine &>(TM)
+              .getSubtargetImpl()
+              ->useSmallSection() &&
+          IsInSmallSection(DL.getTypeAllocSize(CN->getType())));
+}
+
+/// Constant pool entries small enough for the small section are addressed
+/// with %gp_rel, see Cpu0SEDAGToDAGISel::selectConstantPoolLoad.
+MCSection *Cpu0TargetObjectFile::getSectionForConstant(const DataLayout &DL,
+                                                       SectionKind Kind,
+                                                       const Constant *C,
+                                                       Align &Alignment) const {
+  if (IsConstantInSmallSection(DL, C, *TM))
+    return SmallRODataSection;
+
+  // Otherwise, we work the same as ELF.
+  return TargetLoweringObjectFileELF::getSectionForConstant(DL, Kind, C,
+                                                            Alignment);
+}
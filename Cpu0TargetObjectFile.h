@@ -8,6 +8,7 @@
 #define LLVM_LIB_TARGET_CPU0_CPU0TARGETOBJECTFILE_H
 
 #include "Cpu0TargetMachine.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 
 namespace llvm {
@@ -16,16 +17,31 @@ class Cpu0TargetMachine;
 class Cpu0TargetObjectFile : public TargetLoweringObjectFileELF {
   MCSection *SmallDataSection;
   MCSection *SmallBSSSection;
+  MCSection *SmallRODataSection;
   const Cpu0TargetMachine *TM;
+  // Local globals picked for the small sections of the current module.
+  mutable bool ModuleAnalyzed = false;
+  mutable SmallPtrSet<const GlobalVariable *, 16> SmallLocals;
 
   bool IsGlobalInSmallSection(const GlobalObject *GO, const TargetMachine &TM,
                               SectionKind Kind) const;
   bool IsGlobalInSmallSectionImpl(const GlobalObject *GO,
                                   const TargetMachine &TM) const;
 
+  /// Fill the small section budget with M's most frequently accessed local
+  /// globals.
+  void analyzeModule(const Module &M, const TargetMachine &TM) const;
+
 public:
   void Initialize(MCContext &Ctx, const TargetMachine &TM) override;
 
+  /// Forget the local globals picked for the previous module. Called when
+  /// code generation of a module starts.
+  void resetModuleAnalysis() const {
+    ModuleAnalyzed = false;
+    SmallLocals.clear();
+  }
+
   /// IsGlobalInSmallSection - Return true if this global address should be
   /// placed into small data/bss section.
   bool IsGlobalInSmallSection(const GlobalObject *GV,
@@ -33,6 +49,14 @@ public:
 
   MCSection *SelectSectionForGlobal(const GlobalObject *GO, SectionKind Kind,
                                     const TargetMachine &TM) const override;
+
+  /// Return true if this constant should be placed into small data section.
+  bool IsConstantInSmallSection(const DataLayout &DL, const Constant *CN,
+                                const TargetMachine &TM) const;
+
+  MCSection *getSectionForConstant(const DataLayout &DL, SectionKind Kind,
+                                   const Constant *C,
+                                   Align &Alignment) const override;
 };
 } // end namespace llvm
 
@@ -68,7 +68,7 @@ static const unsigned CPURegsTable[] = {
     Cpu0::FP,   Cpu0::SP, Cpu0::LR, Cpu0::SW};
 
 // Decoder tables for co-processor 0 register
-static const unsigned C0RegsTable[] = {Cpu0::PC, Cpu0::EPC};
+static const unsigned C0RegsTable[] = {Cpu0::PC, Cpu0::EPC, Cpu0::TP};
 
 static DecodeStatus DecodeCPURegsRegisterClass(MCInst &Inst, unsigned RegNo,
                                                uint64_t Address,
@@ -86,8 +86,8 @@ static DecodeStatus DecodeBranch16Target(MCInst &Inst, unsigned Insn,
                                          uint64_t Address, const void *Decoder);
 static DecodeStatus DecodeBranch24Target(MCInst &Inst, unsigned Insn,
                                          uint64_t Address, const void *Decoder);
-/*static DecodeStatus DecodeJumpTarget(MCInst &Inst, unsigned Insn,
-                                     uint64_t Address, const void *Decoder);*/
+static DecodeStatus DecodeJumpTarget(MCInst &Inst, unsigned Insn,
+                                     uint64_t Address, const void *Decoder);
 static DecodeStatus DecodeJumpFR(MCInst &Inst, unsigned Insn, uint64_t Address,
                                  const void *Decoder);
 
@@ -191,7 +191,7 @@ static DecodeStatus DecodeSRRegisterClass(MCInst &Inst, unsigned RegNo,
 static DecodeStatus DecodeC0RegsRegisterClass(MCInst &Inst, unsigned RegNo,
                                               uint64_t Address,
                                               const void *Decoder) {
-  if (RegNo > 1)
+  if (RegNo > 2)
     return MCDisassembler::Fail;
 
   Inst.addOperand(MCOperand::createReg(C0RegsTable[RegNo]));
@@ -206,6 +206,10 @@ static DecodeStatus DecodeMem(MCInst &Inst, unsigned Insn, uint64_t Address,
   int Reg = (int)fieldFromInstruction(Insn, 20, 4);
   int Base = (int)fieldFromInstruction(Insn, 16, 4);
 
+  // sc defines $ra and reads it as the value to store.
+  if (Inst.getOpcode() == Cpu0::SC)
+    Inst.addOperand(MCOperand::createReg(CPURegsTable[Reg]));
+
   Inst.addOperand(MCOperand::createReg(CPURegsTable[Reg]));
   Inst.addOperand(MCOperand::createReg(CPURegsTable[Base]));
   Inst.addOperand(MCOperand::createImm(Offset));
@@ -253,13 +257,13 @@ static DecodeStatus DecodeBranch24Target(MCInst &Inst, unsigned Insn,
   return MCDisassembler::Success;
 }
 
-/*static DecodeStatus DecodeJumpTarget(MCInst &Inst, unsigned Insn,
+static DecodeStatus DecodeJumpTarget(MCInst &Inst, unsigned Insn,
                                      uint64_t Address, const void *Decoder) {
 
   unsigned JumpOffset = fieldFromInstruction(Insn, 0, 24);
   Inst.addOperand(MCOperand::createImm(JumpOffset));
   return MCDisassembler::Success;
-}*/
+}
 
 static DecodeStatus DecodeJumpFR(MCInst &Inst, unsigned Insn, uint64_t Address,
                                  const void *Decoder) {
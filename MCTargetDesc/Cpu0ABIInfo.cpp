@@ -21,15 +21,14 @@ static cl::opt<bool> EnableCpu0S32Calls(
     cl::init(false));
 
 namespace {
-static const MCPhysReg O32IntRegs[4] = {Cpu0::A0, Cpu0::A1};
-static const MCPhysReg S32IntRegs = {};
+static const MCPhysReg O32IntRegs[2] = {Cpu0::A0, Cpu0::A1};
 } // namespace
 
 const ArrayRef<MCPhysReg> Cpu0ABIInfo::GetByValArgRegs() const {
   if (IsO32())
     return makeArrayRef(O32IntRegs);
   if (IsS32())
-    return makeArrayRef(S32IntRegs);
+    return None;
   llvm_unreachable("Unhandled ABI");
 }
 
@@ -37,7 +36,7 @@ const ArrayRef<MCPhysReg> Cpu0ABIInfo::GetVarArgRegs() const {
   if (IsO32())
     return makeArrayRef(O32IntRegs);
   if (IsS32())
-    return makeArrayRef(S32IntRegs);
+    return None;
   llvm_unreachable("Unhandled ABI");
 }
 
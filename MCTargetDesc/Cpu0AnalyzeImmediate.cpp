@@ -0,0 +1,120 @@
+// Copyright 2022 All Rights Reserved.
+// Author: lanzongwei541@gmail.com (lanzongwei)
+//
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#include "Cpu0AnalyzeImmediate.h"
+#include "Cpu0MCTargetDesc.h"
+
+#include "llvm/Support/MathExtras.h"
+#include <cassert>
+#include <cstdint>
+
+using namespace llvm;
+
+Cpu0AnalyzeImmediate::Inst::Inst(unsigned O, unsigned I) : Opc(O), ImmOpnd(I) {}
+
+bool Cpu0AnalyzeImmediate::SearchFirst(uint64_t Imm) {
+  int64_t SImm = SignExtend64(Imm, Size);
+
+  // addiu $r, $zero, simm16
+  if (isInt<16>(SImm)) {
+    Path[0] = Inst(Cpu0::ADDiu, Imm & 0xffffULL);
+    return true;
+  }
+
+  // ori $r, $zero, uimm16
+  if (isUInt<16>(Imm)) {
+    Path[0] = Inst(Cpu0::ORi, Imm);
+    return true;
+  }
+
+  // lui $r, imm16
+  if (!(Imm & 0xffffULL) && isInt<16>(SImm >> 16)) {
+    Path[0] = Inst(Cpu0::LUi, (SImm >> 16) & 0xffffULL);
+    return true;
+  }
+
+  return false;
+}
+
+bool Cpu0AnalyzeImmediate::Search(uint64_t Imm, unsigned Len,
+                                  bool LastInstrIsADDiu) {
+  Imm &= Mask;
+
+  if (Len == 1)
+    return SearchFirst(Imm) &&
+           (!LastInstrIsADDiu || Path[0].Opc == Cpu0::ADDiu);
+
+  Inst &Last = Path[Len - 1];
+  uint64_t Lo = Imm & 0xffffULL;
+
+  // addiu $r, $r, lo: the rest is Imm minus the sign-extended lower half.
+  if (Lo || LastInstrIsADDiu) {
+    Last = Inst(Cpu0::ADDiu, Lo);
+    if (Search(Imm - SignExtend64<16>(Lo), Len - 1, false))
+      return true;
+  }
+
+  if (LastInstrIsADDiu)
+    return false;
+
+  if (Lo) {
+    // ori $r, $r, lo: the rest has its lower half cleared.
+    Last = Inst(Cpu0::ORi, Lo);
+    if (Search(Imm & ~0xffffULL, Len - 1, false))
+      return true;
+
+    // xori $r, $r, ~lo: the rest has its lower half set, which suits
+    // negative numbers.
+    Last = Inst(Cpu0::XORi, ~Lo & 0xffffULL);
+    if (Search(Imm | 0xffffULL, Len - 1, false))
+      return true;
+  }
+
+  // shl $r, $r, shamt: the rest is Imm shifted right, either logically or
+  // arithmetically.
+  unsigned Shamt = Imm ? countTrailingZeros(Imm) : 0;
+  if (Shamt) {
+    uint64_t LogicalRest = Imm >> Shamt;
+    uint64_t ArithRest = SignExtend64(Imm, Size) >> Shamt;
+
+    Last = Inst(Cpu0::SHL, Shamt);
+    if (Search(LogicalRest, Len - 1, false))
+      return true;
+    if ((ArithRest & Mask) != LogicalRest && Search(ArithRest, Len - 1, false))
+      return true;
+  }
+
+  return false;
+}
+
+// Sequences are tried by increasing length, so the first one found is the
+// shortest over the forms above. Any 32-bit immediate takes at most two
+// instructions.
+const Cpu0AnalyzeImmediate::InstSeq &
+Cpu0AnalyzeImmediate::Analyze(uint64_t Imm, unsigned Size,
+                              bool LastInstrIsADDiu) {
+  assert(Size && Size <= 64 && "Unexpected immediate size");
+  this->Size = Size;
+  Mask = Size == 64 ? ~0ULL : (1ULL << Size) - 1;
+  Imm &= Mask;
+
+  std::pair<uint64_t, unsigned> Key(Imm, Size << 1 | LastInstrIsADDiu);
+  auto It = Cache.find(Key);
+  if (It != Cache.end()) {
+    Insts = It->second;
+    return Insts;
+  }
+
+  unsigned Len = 1;
+  while (!Search(Imm, Len, LastInstrIsADDiu)) {
+    ++Len;
+    assert(Len <= MaxSeqLength && "No instruction sequence found");
+  }
+
+  Insts.assign(Path, Path + Len);
+  Cache[Key] = Insts;
+  return Insts;
+}
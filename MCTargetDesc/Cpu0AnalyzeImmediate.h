@@ -0,0 +1,56 @@
+// Copyright 2022 All Rights Reserved.
+// Author: lanzongwei541@gmail.com (lanzongwei)
+//
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+#ifndef LLVM_LIB_TARGET_CPU0_MCTARGETDESC_CPU0ANALYZEIMMEDIATE_H
+#define LLVM_LIB_TARGET_CPU0_MCTARGETDESC_CPU0ANALYZEIMMEDIATE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include <cstdint>
+#include <utility>
+
+namespace llvm {
+
+/// Find the shortest sequence of ADDiu/ORi/XORi/LUi/SHL instructions that
+/// loads an immediate. It lives in the MC layer so that both code generation
+/// and the assembler's "li" expansion use it. Results are cached, keep one
+/// instance around for the whole compilation.
+class Cpu0AnalyzeImmediate {
+public:
+  struct Inst {
+    unsigned Opc, ImmOpnd;
+
+    Inst() : Opc(0), ImmOpnd(0) {}
+    Inst(unsigned Opc, unsigned ImmOpnd);
+  };
+  /// The longest sequence, for a 64-bit immediate, has 7 instructions.
+  static const unsigned MaxSeqLength = 7;
+  using InstSeq = SmallVector<Inst, MaxSeqLength>;
+
+  /// Analyze - Get an instruction sequence to load immediate Imm. The last
+  /// instruction in the sequence must be an ADDiu if LastInstrIsADDiu is
+  /// true;
+  const InstSeq &Analyze(uint64_t Imm, unsigned Size, bool LastInstrIsADDiu);
+
+private:
+  /// Search - Try to build Imm from $zero with exactly Len instructions,
+  /// working backwards from the last one. On success the instructions are
+  /// in Path[0, Len).
+  bool Search(uint64_t Imm, unsigned Len, bool LastInstrIsADDiu);
+
+  /// SearchFirst - Whether a single instruction reading $zero loads Imm.
+  bool SearchFirst(uint64_t Imm);
+
+  unsigned Size;
+  uint64_t Mask;
+  Inst Path[MaxSeqLength];
+  InstSeq Insts;
+  /// Keyed on the immediate and (Size << 1 | LastInstrIsADDiu).
+  DenseMap<std::pair<uint64_t, unsigned>, InstSeq> Cache;
+};
+} // namespace llvm
+
+#endif
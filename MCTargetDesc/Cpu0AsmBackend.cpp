@@ -46,6 +46,10 @@ static unsigned adjustFixupValue(const MCFixup &Fixup, uint64_t Value,
   case FK_Data_4:
   case Cpu0::fixup_Cpu0_LO16:
   case Cpu0::fixup_Cpu0_GOT_LO16:
+  case Cpu0::fixup_Cpu0_CALL16:
+  case Cpu0::fixup_Cpu0_TLSGD:
+  case Cpu0::fixup_Cpu0_GOTTPREL:
+  case Cpu0::fixup_Cpu0_TP_LO:
     break;
   case Cpu0::fixup_Cpu0_PC16:
   case Cpu0::fixup_Cpu0_PC24:
@@ -57,6 +61,7 @@ static unsigned adjustFixupValue(const MCFixup &Fixup, uint64_t Value,
   case Cpu0::fixup_Cpu0_HI16:
   case Cpu0::fixup_Cpu0_GOT:
   case Cpu0::fixup_Cpu0_GOT_HI16:
+  case Cpu0::fixup_Cpu0_TP_HI:
     // Get the higher 16-bits. Also add 1 if bit 15 is 1.
     Value = (Value >> 16) & 0xffff;
     break;
@@ -139,7 +144,12 @@ Cpu0AsmBackend::getFixupKindInfo(MCFixupKind Kind) const {
       {"fixup_Cpu0_PC16", 0, 16, MCFixupKindInfo::FKF_IsPCRel},
       {"fixup_Cpu0_PC24", 0, 24, JSUBReloRec},
       {"fixup_Cpu0_GOT_HI16", 0, 16, 0},
-      {"fixup_Cpu0_GOT_LO16", 0, 16, 0}};
+      {"fixup_Cpu0_GOT_LO16", 0, 16, 0},
+      {"fixup_Cpu0_CALL16", 0, 16, 0},
+      {"fixup_Cpu0_TLSGD", 0, 16, 0},
+      {"fixup_Cpu0_GOTTPREL", 0, 16, 0},
+      {"fixup_Cpu0_TP_HI", 0, 16, 0},
+      {"fixup_Cpu0_TP_LO", 0, 16, 0}};
 
   if (Kind < FirstTargetFixupKind)
     return MCAsmBackend::getFixupKindInfo(Kind);
@@ -53,7 +53,26 @@ enum TOF {
 
   /// MO_GOT_HI16/LO16 - Relocations used for large GOTs.
   MO_GOT_HI16,
-  MO_GOT_LO16
+  MO_GOT_LO16,
+
+  /// MO_TLSGD - Represents the offset into the global offset table at which
+  /// the module ID and TLS block offset reside during execution (General
+  /// Dynamic TLS).
+  MO_TLSGD,
+
+  /// MO_GOTTPREL - Represents the offset from the thread pointer (Initial
+  /// Exec TLS).
+  MO_GOTTPREL,
+
+  /// MO_TP_HI/LO - Represents the hi and low part of the offset from
+  /// the thread pointer (Local Exec TLS).
+  MO_TP_HI,
+  MO_TP_LO,
+
+  /// MO_CALL_HINT - Names the callee of a jalr whose target was loaded into
+  /// t9, so that interprocedural register allocation can find the callee's
+  /// register usage. It is never emitted.
+  MO_CALL_HINT
 }; // enum TOF {
 
 enum {
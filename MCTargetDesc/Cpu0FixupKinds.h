@@ -51,6 +51,21 @@ enum Fixups {
   // resulting in - R_CPU0_GOT_LO16
   fixup_Cpu0_GOT_LO16,
 
+  // Function call through the GOT resulting in - R_CPU0_CALL16.
+  fixup_Cpu0_CALL16,
+
+  // resulting in - R_CPU0_TLS_GD.
+  fixup_Cpu0_TLSGD,
+
+  // resulting in - R_CPU0_TLS_GOTTPREL.
+  fixup_Cpu0_GOTTPREL,
+
+  // resulting in - R_CPU0_TLS_TP_HI16.
+  fixup_Cpu0_TP_HI,
+
+  // resulting in - R_CPU0_TLS_TP_LO16.
+  fixup_Cpu0_TP_LO,
+
   // Marker
   LastTargetFixupKind,
   NumTargetFixupKinds = LastTargetFixupKind - FirstTargetFixupKind
@@ -150,7 +150,7 @@ Cpu0MCCodeEmitter::getJumpTargetOpValue(const MCInst &MI, unsigned OpNo,
   assert(MO.isExpr() && "getJumpTargetOpValue expects only expressions");
 
   const MCExpr *Expr = MO.getExpr();
-  if (Opcode == Cpu0::JMP || Opcode == Cpu0::BAL)
+  if (Opcode == Cpu0::JSUB || Opcode == Cpu0::JMP || Opcode == Cpu0::BAL)
     Fixups.push_back(
         MCFixup::create(0, Expr, MCFixupKind(Cpu0::fixup_Cpu0_PC24)));
   else
@@ -186,6 +186,9 @@ unsigned Cpu0MCCodeEmitter::getExprOpValue(const MCExpr *Expr,
     case Cpu0MCExpr::CEK_GOT:
       FixupKind = Cpu0::fixup_Cpu0_GOT;
       break;
+    case Cpu0MCExpr::CEK_GOT_CALL:
+      FixupKind = Cpu0::fixup_Cpu0_CALL16;
+      break;
     case Cpu0MCExpr::CEK_ABS_HI:
       FixupKind = Cpu0::fixup_Cpu0_HI16;
       break;
@@ -198,6 +201,18 @@ unsigned Cpu0MCCodeEmitter::getExprOpValue(const MCExpr *Expr,
     case Cpu0MCExpr::CEK_GOT_LO16:
       FixupKind = Cpu0::fixup_Cpu0_GOT_LO16;
       break;
+    case Cpu0MCExpr::CEK_TLSGD:
+      FixupKind = Cpu0::fixup_Cpu0_TLSGD;
+      break;
+    case Cpu0MCExpr::CEK_GOTTPREL:
+      FixupKind = Cpu0::fixup_Cpu0_GOTTPREL;
+      break;
+    case Cpu0MCExpr::CEK_TP_HI:
+      FixupKind = Cpu0::fixup_Cpu0_TP_HI;
+      break;
+    case Cpu0MCExpr::CEK_TP_LO:
+      FixupKind = Cpu0::fixup_Cpu0_TP_LO;
+      break;
     } // switch
     Fixups.push_back(MCFixup::create(0, Expr, MCFixupKind(FixupKind)));
     return 0;
@@ -122,14 +122,48 @@ void Cpu0MCExpr::visitUsedExpr(MCStreamer &Streamer) const {
   Streamer.visitUsedExpr(*getSubExpr());
 }
 
+// Mark the symbols a TLS relocation refers to as STT_TLS.
+static void fixELFSymbolsInTLSFixupsImpl(const MCExpr *Expr,
+                                         MCAssembler &Asm) {
+  switch (Expr->getKind()) {
+  case MCExpr::Target:
+    fixELFSymbolsInTLSFixupsImpl(cast<Cpu0MCExpr>(Expr)->getSubExpr(), Asm);
+    break;
+  case MCExpr::Constant:
+    break;
+  case MCExpr::Binary: {
+    const MCBinaryExpr *BE = cast<MCBinaryExpr>(Expr);
+    fixELFSymbolsInTLSFixupsImpl(BE->getLHS(), Asm);
+    fixELFSymbolsInTLSFixupsImpl(BE->getRHS(), Asm);
+    break;
+  }
+  case MCExpr::SymbolRef: {
+    const MCSymbolRefExpr &SymRef = *cast<MCSymbolRefExpr>(Expr);
+    cast<MCSymbolELF>(SymRef.getSymbol()).setType(ELF::STT_TLS);
+    break;
+  }
+  case MCExpr::Unary:
+    fixELFSymbolsInTLSFixupsImpl(cast<MCUnaryExpr>(Expr)->getSubExpr(), Asm);
+    break;
+  }
+}
+
 void Cpu0MCExpr::fixELFSymbolsInTLSFixups(MCAssembler &Asm) const {
   switch ((int)getKind()) {
   case CEK_None:
   case CEK_Special:
     llvm_unreachable("CEK_None and CEK_Special are invalid");
     break;
-  case CEK_CALL_HI16:
-  case CEK_CALL_LO16:
+  case CEK_DTP_HI:
+  case CEK_DTP_LO:
+  case CEK_GOTTPREL:
+  case CEK_TLSGD:
+  case CEK_TLSLDM:
+  case CEK_TP_HI:
+  case CEK_TP_LO:
+    fixELFSymbolsInTLSFixupsImpl(getSubExpr(), Asm);
+    break;
+  default:
     break;
   }
 }